@@ -0,0 +1,544 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class EncodedAlignment: Aligned amino acids sequences encoded once into small integer codes, stocked in one contiguous buffer.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+#include <unordered_map>
+#include <math.h>
+
+#include "alignement.hpp"
+#include "parallele.hpp"
+#include "journal.hpp"
+
+using namespace std;
+
+// Code of a character which has not been seen yet
+const uint8_t CODE_ABSENT = 255;
+
+// EncodedAlignment Class constructor: encode all sequences of the struct fasta vector
+EncodedAlignment::EncodedAlignment(const vector<fasta>& vecFasta)
+{
+    initialiser(vecFasta.size(), vecFasta.empty() ? 0 : vecFasta[0].s.size());
+    for (int i = 0; i < nbSequences; i++)
+    {
+        ajouterSequence(i, vecFasta[i].e, vecFasta[i].n, vecFasta[i].s);
+    }
+    journal() << "EncodedAlignment Class constructor.\n";
+}
+
+// EncodedAlignment Class constructor: encode all sequences of the mapped FASTA file (no copy of the sequences)
+EncodedAlignment::EncodedAlignment(const vector<vueFasta>& vecFasta)
+{
+    initialiser(vecFasta.size(), vecFasta.empty() ? 0 : vecFasta[0].s.size());
+    for (int i = 0; i < nbSequences; i++)
+    {
+        ajouterSequence(i, vecFasta[i].e, vecFasta[i].n, vecFasta[i].s);
+    }
+    journal() << "EncodedAlignment Class constructor.\n";
+}
+
+// Function to allocate the buffer and create the reserved codes
+void EncodedAlignment::initialiser(int sequences, size_t colonnes)
+{
+    nbSequences = sequences;
+    longueur = colonnes;
+
+    // Rows are rounded to 64 bytes so each row begins on a 64 bytes boundary
+    pas = ((longueur + ALIGNEMENT_OCTETS - 1) / ALIGNEMENT_OCTETS) * ALIGNEMENT_OCTETS;
+    if (pas == 0)
+    {
+        pas = ALIGNEMENT_OCTETS;
+    }
+
+    donnees = (uint8_t*)aligned_alloc(ALIGNEMENT_OCTETS, (size_t)max(nbSequences, 1) * pas);
+    // If no memory can be allocated, the alignment is empty (0 sequences): the caller checks the number of sequences
+    if (donnees == NULL)
+    {
+        cerr << "Error: impossible to allocate memory for the alignment.\n";
+        nbSequences = 0;
+        longueur = 0;
+    }else{
+        // The end of the rows are gaps: they are never compared
+        memset(donnees, CODE_GAP, (size_t)max(nbSequences, 1) * pas);
+    }
+    entetes.resize(nbSequences);
+    numeros.resize(nbSequences);
+
+    // Reserved codes: gaps and unknown amino acids, then the 20 amino acids
+    memset(codes, CODE_ABSENT, sizeof(codes));
+    memset(residus, 0, sizeof(residus));
+    codes[(unsigned char)'-'] = CODE_GAP;
+    residus[CODE_GAP] = '-';
+    codes[(unsigned char)'X'] = CODE_INCONNU;
+    codes[(unsigned char)'x'] = CODE_INCONNU;
+    residus[CODE_INCONNU] = 'X';
+    nbCodes = 2;
+    const char* acidesAmines = "ACDEFGHIKLMNPQRSTVWY";
+    for (int a = 0; acidesAmines[a] != '\0'; a++)
+    {
+        encoder(acidesAmines[a]);
+    }
+}
+
+// Function to encode the sequence i and stock its header (other characters get their own code so they are still compared)
+void EncodedAlignment::ajouterSequence(int i, string_view entete, int numero, string_view sequence)
+{
+    entetes[i] = string(entete);
+    numeros[i] = numero;
+    uint8_t* ligne = donnees + (size_t)i * pas;
+    size_t tailleLigne = min(sequence.size(), longueur);
+    for (size_t k = 0; k < tailleLigne; k++)
+    {
+        uint8_t code = codes[(unsigned char)sequence[k]];
+        ligne[k] = (code != CODE_ABSENT) ? code : encoder(sequence[k]);
+    }
+}
+
+// EncodedAlignment Class destructor
+EncodedAlignment::~EncodedAlignment()
+{
+    free(donnees);
+    journal() << "EncodedAlignment Class destructor.\n";
+}
+
+// Function to give a code to a character (new characters get the next free code)
+uint8_t EncodedAlignment::encoder(unsigned char residu)
+{
+    if (codes[residu] == CODE_ABSENT)
+    {
+        codes[residu] = nbCodes;
+        residus[nbCodes] = residu;
+        nbCodes++;
+    }
+    return codes[residu];
+}
+
+// Function to decode the sequence i
+string EncodedAlignment::decoder(int i) const
+{
+    string sequenceDecodee(longueur, ' ');
+    const uint8_t* ligne = sequence(i);
+    for (size_t k = 0; k < longueur; k++)
+    {
+        sequenceDecodee[k] = residus[ligne[k]];
+    }
+    return sequenceDecodee;
+}
+
+// Function to remove columns of the alignment (gaps, or more than seuil % of gaps and unknown amino acids) on nbThreads threads
+size_t EncodedAlignment::filtrerColonnes(bool sansGaps, double seuil, int nbThreads)
+{
+    bool compter = (seuil >= 0.0);
+    // A column is removed if it has more than maximum gaps and unknown amino acids
+    size_t maximum = compter ? (size_t)floor(seuil * nbSequences / 100.0 + 1e-9) : 0;
+
+    // Bitmap of the kept columns (bits after the last column are 0)
+    size_t nbMots = (longueur + 63) / 64;
+    vector<uint64_t> gardees(nbMots, 0);
+
+    Parallele parallele(nbThreads);
+
+    /*
+    Blocks of 4096 columns (64 words of the bitmap, written by only one thread): for each row, OR of the gaps
+    and count of the gaps and unknown amino acids of the block (loops on bytes, vectorized by the compiler)
+    */
+    const size_t COLONNES_BLOC = 4096;
+    size_t nbBlocs = (longueur + COLONNES_BLOC - 1) / COLONNES_BLOC;
+    parallele.executer(nbBlocs, [&](size_t bloc)
+    {
+        size_t debut = bloc * COLONNES_BLOC;
+        size_t taille = min(longueur, debut + COLONNES_BLOC) - debut;
+        vector<uint8_t> gaps(taille, 0);
+        vector<uint32_t> manquants(compter ? taille : 0, 0);
+        for (int i = 0; i < nbSequences; i++)
+        {
+            const uint8_t* ligne = sequence(i) + debut;
+            for (size_t k = 0; k < taille; k++)
+            {
+                gaps[k] |= (ligne[k] == CODE_GAP);
+            }
+            if (compter)
+            {
+                for (size_t k = 0; k < taille; k++)
+                {
+                    manquants[k] += (ligne[k] <= CODE_INCONNU);
+                }
+            }
+        }
+        for (size_t k = 0; k < taille; k++)
+        {
+            bool garder = !(sansGaps && gaps[k]) && !(compter && (manquants[k] > maximum));
+            if (garder)
+            {
+                gardees[(debut + k) / 64] |= (uint64_t)1 << ((debut + k) % 64);
+            }
+        }
+    });
+
+    size_t nbColonnes = 0;
+    for (uint64_t mot : gardees)
+    {
+        nbColonnes += __builtin_popcountll(mot);
+    }
+    if (nbColonnes == longueur)
+    {
+        return 0;
+    }
+
+    // Compaction of each row in place: kept columns are moved to the beginning of the row (64 columns at once if all are kept)
+    parallele.executer(nbSequences, [&](size_t i)
+    {
+        uint8_t* ligne = donnees + i * pas;
+        size_t c = 0;
+        for (size_t m = 0; m < nbMots; m++)
+        {
+            uint64_t mot = gardees[m];
+            if (mot == ~(uint64_t)0)
+            {
+                memmove(ligne + c, ligne + m * 64, 64);
+                c += 64;
+                continue;
+            }
+            while (mot != 0)
+            {
+                ligne[c++] = ligne[m * 64 + __builtin_ctzll(mot)];
+                mot &= mot - 1;
+            }
+        }
+        memset(ligne + c, CODE_GAP, pas - c);
+    });
+    size_t supprimees = longueur - nbColonnes;
+    longueur = nbColonnes;
+    return supprimees;
+}
+
+// FNV-1a 64 bits hash constants
+const uint64_t FNV_BASE = 14695981039346656037ULL;
+const uint64_t FNV_PREMIER = 1099511628211ULL;
+
+// Function to get the hash (FNV-1a 64 bits) of the header and the residues of sequence i
+uint64_t EncodedAlignment::empreinteSequence(int i) const
+{
+    // Compressed alignment: hash of the rows before the compression
+    if (!empreintes.empty())
+    {
+        return empreintes[i];
+    }
+    uint64_t empreinte = FNV_BASE;
+    for (unsigned char c : entetes[i])
+    {
+        empreinte = (empreinte ^ c) * FNV_PREMIER;
+    }
+    empreinte = (empreinte ^ '\n') * FNV_PREMIER;
+    // Residues are hashed, not codes: the hash does not depend on the order codes were given
+    const uint8_t* ligne = sequence(i);
+    for (size_t k = 0; k < longueur; k++)
+    {
+        empreinte = (empreinte ^ (unsigned char)residus[ligne[k]]) * FNV_PREMIER;
+    }
+    return empreinte;
+}
+
+// Function to get the hash of the alignment (headers and residues of all sequences, in order)
+uint64_t EncodedAlignment::empreinte() const
+{
+    uint64_t empreinte = FNV_BASE;
+    for (int i = 0; i < nbSequences; i++)
+    {
+        uint64_t empreinteLigne = empreinteSequence(i);
+        for (int o = 0; o < 8; o++)
+        {
+            empreinte = (empreinte ^ ((empreinteLigne >> (8 * o)) & 0xff)) * FNV_PREMIER;
+        }
+    }
+    return empreinte;
+}
+
+// Function to compress the alignment in site patterns (unique columns with a weight) on nbThreads threads
+size_t EncodedAlignment::compresserColonnes(int nbThreads)
+{
+    if (!segments.empty() || (longueur == 0))
+    {
+        return 0;
+    }
+    Parallele parallele(nbThreads);
+
+    // Hash of each column and number of compared sites (neither gap nor unknown amino acid), by blocks of 1024 columns read row by row
+    vector<uint64_t> hachages(longueur, FNV_BASE);
+    vector<uint32_t> comparees(longueur, 0);
+    const size_t COLONNES_BLOC = 1024;
+    size_t nbBlocs = (longueur + COLONNES_BLOC - 1) / COLONNES_BLOC;
+    parallele.executer(nbBlocs, [&](size_t bloc)
+    {
+        size_t debut = bloc * COLONNES_BLOC;
+        size_t fin = min(longueur, debut + COLONNES_BLOC);
+        for (int i = 0; i < nbSequences; i++)
+        {
+            const uint8_t* ligne = sequence(i);
+            for (size_t k = debut; k < fin; k++)
+            {
+                hachages[k] = (hachages[k] ^ ligne[k]) * FNV_PREMIER;
+                comparees[k] += (ligne[k] > CODE_INCONNU);
+            }
+        }
+    });
+
+    // Pattern of each column: first column with the same hash (a column compared in less than two sequences is never counted)
+    const size_t AUCUN = (size_t)-1;
+    vector<size_t> motif(longueur, AUCUN);
+    unordered_map<uint64_t, size_t> premieres;
+    premieres.reserve(longueur);
+    for (size_t k = 0; k < longueur; k++)
+    {
+        if (comparees[k] >= 2)
+        {
+            motif[k] = premieres.emplace(hachages[k], k).first->second;
+        }
+    }
+
+    // Columns are checked with the first column of their pattern (two different columns with the same hash keep their own pattern)
+    vector<uint8_t> differentes(longueur, 0);
+    parallele.executer(nbBlocs, [&](size_t bloc)
+    {
+        size_t debut = bloc * COLONNES_BLOC;
+        size_t fin = min(longueur, debut + COLONNES_BLOC);
+        for (int i = 0; i < nbSequences; i++)
+        {
+            const uint8_t* ligne = sequence(i);
+            for (size_t k = debut; k < fin; k++)
+            {
+                if (motif[k] != AUCUN)
+                {
+                    differentes[k] |= (ligne[k] != ligne[motif[k]]);
+                }
+            }
+        }
+    });
+
+    // Weight of each pattern, the patterns are kept in the order of their first column
+    vector<uint64_t> poids(longueur, 0);
+    vector<size_t> motifs;
+    for (size_t k = 0; k < longueur; k++)
+    {
+        if (motif[k] == AUCUN)
+        {
+            continue;
+        }
+        if (differentes[k])
+        {
+            motif[k] = k;
+        }
+        if (motif[k] == k)
+        {
+            motifs.push_back(k);
+        }
+        poids[motif[k]]++;
+    }
+
+    // Segment of weight 2^b: patterns with the bit b in their weight, rounded to 64 columns
+    vector<segmentColonnes> nouveauxSegments;
+    vector<size_t> origines; // Column of the alignment read for each column of the segments (AUCUN: gap at the end of a segment)
+    for (int b = 0; b < 64; b++)
+    {
+        segmentColonnes segment;
+        segment.debut = origines.size();
+        segment.poids = (uint64_t)1 << b;
+        for (size_t k : motifs)
+        {
+            if (poids[k] & segment.poids)
+            {
+                origines.push_back(k);
+            }
+        }
+        segment.taille = origines.size() - segment.debut;
+        if (segment.taille == 0)
+        {
+            continue;
+        }
+        segment.utiles = segment.taille;
+        segment.taille = ((segment.taille + ALIGNEMENT_OCTETS - 1) / ALIGNEMENT_OCTETS) * ALIGNEMENT_OCTETS;
+        origines.resize(segment.debut + segment.taille, AUCUN);
+        nouveauxSegments.push_back(segment);
+    }
+
+    // Not compressed if the segments are not shorter than the columns rounded to 64
+    if (nouveauxSegments.empty() || (origines.size() >= ((longueur + ALIGNEMENT_OCTETS - 1) / ALIGNEMENT_OCTETS) * ALIGNEMENT_OCTETS))
+    {
+        return 0;
+    }
+
+    // The hash of the sequences doesn't depend on the compression (headers and residues of the alignment)
+    vector<uint64_t> empreintesLignes(nbSequences);
+    parallele.executer(nbSequences, [&](size_t i)
+    {
+        empreintesLignes[i] = empreinteSequence(i);
+    });
+
+    // Rows are rewritten in a new buffer with the columns of the segments: the rows are shorter, so the pairs read less memory
+    size_t nouveauPas = origines.size();
+    uint8_t* compressees = (uint8_t*)aligned_alloc(ALIGNEMENT_OCTETS, (size_t)nbSequences * nouveauPas);
+    if (compressees == NULL)
+    {
+        return 0;
+    }
+    parallele.executer(nbSequences, [&](size_t i)
+    {
+        const uint8_t* ligne = sequence(i);
+        uint8_t* compressee = compressees + i * nouveauPas;
+        for (size_t c = 0; c < nouveauPas; c++)
+        {
+            compressee[c] = (origines[c] != AUCUN) ? ligne[origines[c]] : CODE_GAP;
+        }
+    });
+    free(donnees);
+    donnees = compressees;
+    pas = nouveauPas;
+    empreintes.swap(empreintesLignes);
+    segments.swap(nouveauxSegments);
+    longueur = origines.size();
+    return motifs.size();
+}
+
+// Function to group the identical sequences (same residues after the gap policy) and stock the first sequence of each group
+vector<int> EncodedAlignment::grouperSequences(vector<int>& uniques, int nbThreads) const
+{
+    // Hash of each row by 64 bits words (the end of the rows are gaps in all sequences)
+    vector<uint64_t> hachages(nbSequences, FNV_BASE);
+    {
+        Parallele parallele(nbThreads);
+        parallele.executer(nbSequences, [&](size_t i)
+        {
+            const uint8_t* ligne = sequence(i);
+            uint64_t hachage = FNV_BASE;
+            for (size_t k = 0; k < pas; k += 8)
+            {
+                uint64_t mot;
+                memcpy(&mot, ligne + k, 8);
+                hachage = (hachage ^ mot) * FNV_PREMIER;
+                hachage ^= hachage >> 29;
+            }
+            hachages[i] = hachage;
+        });
+    }
+
+    // Group of each sequence: group of the first sequence with the same hash and the same residues
+    vector<int> groupes(nbSequences);
+    unordered_map<uint64_t, vector<int>> candidats;
+    candidats.reserve(nbSequences);
+    uniques.clear();
+    for (int i = 0; i < nbSequences; i++)
+    {
+        vector<int>& memeHachage = candidats[hachages[i]];
+        int groupe = -1;
+        for (int g : memeHachage)
+        {
+            if (memcmp(sequence(uniques[g]), sequence(i), pas) == 0)
+            {
+                groupe = g;
+                break;
+            }
+        }
+        if (groupe < 0)
+        {
+            groupe = uniques.size();
+            uniques.push_back(i);
+            memeHachage.push_back(groupe);
+        }
+        groupes[i] = groupe;
+    }
+    return groupes;
+}
+
+// Function to get the number of columns counted with their weight: largest number of compared sites of a pair
+uint64_t EncodedAlignment::colonnesPonderees() const
+{
+    if (segments.empty())
+    {
+        return longueur;
+    }
+    uint64_t colonnes = 0;
+    for (const segmentColonnes& segment : segments)
+    {
+        colonnes += segment.poids * segment.utiles; // The gaps of the end of the segment are never compared
+    }
+    return colonnes;
+}
+
+// Function to check if all the sites of the alignment are compared (no gap and no unknown amino acid in the columns)
+bool EncodedAlignment::sansManquants() const
+{
+    // Columns of the alignment: all the columns, or the columns of each segment without the gaps of the end
+    vector<segmentColonnes> colonnes = segments;
+    if (colonnes.empty())
+    {
+        colonnes.push_back({0, longueur, longueur, 1});
+    }
+    for (int i = 0; i < nbSequences; i++)
+    {
+        const uint8_t* ligne = sequence(i);
+        for (const segmentColonnes& segment : colonnes)
+        {
+            // Smallest code of the columns (loop vectorized by the compiler)
+            uint8_t minimum = 255;
+            for (size_t k = segment.debut; k < segment.debut + segment.utiles; k++)
+            {
+                minimum = min(minimum, ligne[k]);
+            }
+            if (minimum <= CODE_INCONNU)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Function to count the compared sites of sequence i (neither gap nor unknown amino acid, weighted by the site patterns)
+uint64_t EncodedAlignment::sitesCompares(int i) const
+{
+    const uint8_t* ligne = sequence(i);
+    if (segments.empty())
+    {
+        uint64_t sites = 0;
+        for (size_t k = 0; k < longueur; k++)
+        {
+            sites += (ligne[k] > CODE_INCONNU);
+        }
+        return sites;
+    }
+    uint64_t sites = 0;
+    for (const segmentColonnes& segment : segments)
+    {
+        uint64_t sitesSegment = 0;
+        for (size_t k = segment.debut; k < segment.debut + segment.taille; k++)
+        {
+            sitesSegment += (ligne[k] > CODE_INCONNU);
+        }
+        sites += segment.poids * sitesSegment;
+    }
+    return sites;
+}
@@ -0,0 +1,172 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class EncodedAlignment: Aligned amino acids sequences encoded once into small integer codes, stocked in one contiguous buffer.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+#include "fasta.hpp" // fasta.hpp inclusion to use struct fasta and struct vueFasta
+
+#ifndef ALIGNEMENT_HPP
+#define ALIGNEMENT_HPP
+
+/*
+ Codes réservés de l'alignement encodé.
+ Les gaps "-" et les acides aminés inconnus "X" ou "x" ont les plus petits codes: un site est comparé si son code est supérieur à CODE_INCONNU
+*/
+const uint8_t CODE_GAP = 0; // Gap "-"
+const uint8_t CODE_INCONNU = 1; // Unknown amino acid "X" or "x"
+
+// Alignment of the rows in memory (bytes): one row can be read by 64 bytes blocks (AVX-512)
+const size_t ALIGNEMENT_OCTETS = 64;
+
+/*
+ Segment de colonnes d'un alignement compressé en motifs de sites: chaque colonne du segment représente poids colonnes de l'alignement.
+ Les segments commencent sur une frontière de 64 colonnes et leur fin est complétée par des gaps (jamais comparés)
+*/
+struct segmentColonnes
+{
+  size_t debut; // First column of the segment (multiple of 64)
+  size_t taille; // Number of columns of the segment (multiple of 64)
+  size_t utiles; // Number of columns of the segment before the gaps of the end
+  uint64_t poids; // Weight of each column of the segment
+};
+
+class EncodedAlignment
+{
+  private:
+    int nbSequences; // Number of sequences
+
+    size_t longueur; // Number of columns of the alignment
+
+    size_t pas; // Length of one row in the buffer (longueur rounded to 64 bytes, the end of the row is filled with CODE_GAP)
+
+    uint8_t* donnees; // Encoded sequences, row i begins at donnees + i*pas
+
+    std::vector<std::string> entetes; // Headers
+
+    std::vector<int> numeros; // Header numbers
+
+    uint8_t codes[256]; // Code of each character
+
+    char residus[256]; // Character of each code
+
+    int nbCodes; // Number of used codes
+
+    std::vector<segmentColonnes> segments; // Segments of weighted columns (empty: the alignment is not compressed, each column has weight 1)
+
+    std::vector<uint64_t> empreintes; // Hash of each sequence before the compression (empty: calculated from the rows)
+
+    // Function to give a code to a character (new characters get the next free code)
+    uint8_t encoder(unsigned char residu);
+
+    // Function to allocate the buffer and create the reserved codes
+    void initialiser(int sequences, size_t colonnes);
+
+    // Function to encode the sequence i and stock its header
+    void ajouterSequence(int i, std::string_view entete, int numero, std::string_view sequence);
+
+  public:
+    // EncodedAlignment Class constructor: encode all sequences of the struct fasta vector (empty alignment if the memory can't be allocated)
+    EncodedAlignment(const std::vector<fasta>& vecFasta);
+
+    // EncodedAlignment Class constructor: encode all sequences of the mapped FASTA file, no copy of the sequences (empty alignment if the memory can't be allocated)
+    EncodedAlignment(const std::vector<vueFasta>& vecFasta);
+
+    // EncodedAlignment Class destructor
+    ~EncodedAlignment();
+
+    // The buffer is not shared between two objects
+    EncodedAlignment(const EncodedAlignment&) = delete;
+    EncodedAlignment& operator=(const EncodedAlignment&) = delete;
+
+    // Function to stock the number of sequences
+    int nombreSequences() const { return nbSequences; };
+
+    // Function to stock the number of columns of the alignment
+    size_t taille() const { return longueur; };
+
+    // Function to stock the length of one row in the buffer (multiple of 64)
+    size_t pasLigne() const { return pas; };
+
+    // Function to stock the number of used codes (reserved codes included)
+    int nombreCodes() const { return nbCodes; };
+
+    // Function to get the encoded sequence i (pasLigne() bytes, 64 bytes aligned)
+    const uint8_t* sequence(int i) const { return donnees + (size_t)i * pas; };
+
+    // Function to get the header of sequence i
+    const std::string& entete(int i) const { return entetes[i]; };
+
+    // Function to get the header number of sequence i
+    int numero(int i) const { return numeros[i]; };
+
+    // Function to get the character of a code
+    char residu(uint8_t code) const { return residus[code]; };
+
+    // Function to decode the sequence i
+    std::string decoder(int i) const;
+
+    /*
+      Function to remove columns of the alignment on nbThreads threads (return the number of removed columns):
+        sansGaps: columns with a gap in at least one sequence are removed
+        seuil >= 0: columns with more than seuil % of gaps and unknown amino acids (X) are removed
+      The kept columns are marked in a bitmap (OR and counts of the codes by blocks of columns), then each row is compacted in place
+    */
+    size_t filtrerColonnes(bool sansGaps, double seuil, int nbThreads = 1);
+
+    /*
+      Function to compress the alignment in site patterns on nbThreads threads (return the number of unique patterns, 0: not compressed):
+        Identical columns are counted once with their number of copies as weight, columns compared in less than two sequences are removed
+        Weight w = sum of 2^b: the patterns with the bit b in their weight are stocked in the segment of weight 2^b,
+        so the counts of a pair are the sum of the counts of each segment times its weight (exact counts)
+      Must be called after filtrerColonnes, the hash of the sequences is kept
+    */
+    size_t compresserColonnes(int nbThreads = 1);
+
+    // Function to get the segments of weighted columns (empty if the alignment is not compressed)
+    const std::vector<segmentColonnes>& segmentsPonderes() const { return segments; };
+
+    /*
+      Function to group the identical sequences (same residues after the gap policy) on nbThreads threads:
+        Return the group of each sequence, numbered in the order of their first sequence, and stock the first sequence of each group in uniques
+        Rows are hashed by 64 bits words, sequences with the same hash are compared byte to byte
+    */
+    std::vector<int> grouperSequences(std::vector<int>& uniques, int nbThreads = 1) const;
+
+    // Function to get the number of columns counted with their weight: largest number of compared sites of a pair
+    uint64_t colonnesPonderees() const;
+
+    // Function to check if all the sites of the alignment are compared (no gap and no unknown amino acid in the columns)
+    bool sansManquants() const;
+
+    // Function to count the compared sites of sequence i (neither gap nor unknown amino acid, weighted by the site patterns)
+    uint64_t sitesCompares(int i) const;
+
+    // Function to get the hash (FNV-1a 64 bits) of the header and the residues of sequence i
+    uint64_t empreinteSequence(int i) const;
+
+    // Function to get the hash of the alignment (headers and residues of all sequences, in order)
+    uint64_t empreinte() const;
+};
+#endif
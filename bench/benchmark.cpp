@@ -0,0 +1,401 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Benchmark of Align: synthetic protein alignments (number of sequences, length, gap fraction and divergence) and time of each stage
+    of the program on a grid of sizes, with the throughput of each stage (pairs/s, columns/s, MB/s) stored in a JSON file.
+
+    ./align-bench [-n 500,1000,2000] [-L 200,1000] [-g GAPS] [-v DIVERGENCE] [-t THREADS] [-e ENGINE] [-r REPEATS] [-s SEED]
+                  [-d DIR] [-j results.json] [-b baseline.json]
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <random>
+#include <ctime>
+#include <functional>
+#include <filesystem>
+#include <string.h>
+#include <unistd.h>
+
+#include "../fasta.hpp"
+#include "../alignement.hpp"
+#include "../matrice.hpp"
+#include "../divergence.hpp"
+#include "../methode.hpp"
+#include "../moteur.hpp"
+
+using namespace std;
+
+/*
+ Paramètres d'un alignement synthétique
+*/
+struct parametresSynthese
+{
+  int nbSequences; // Number of sequences
+  size_t longueur; // Number of columns
+  double gaps; // Probability of a gap at each site of each sequence (gaps by runs of 1 to 8 sites)
+  double divergence; // Probability of a substitution at each site between a sequence and the ancestral sequence
+  uint64_t graine; // Seed of the random generator
+};
+
+/*
+ Mesure d'une étape: temps (meilleur de plusieurs répétitions) et débit
+*/
+struct mesureEtape
+{
+  std::string etape; // Name of the stage
+  double secondes; // Best wall-clock time of the repetitions
+  double volume; // Quantity processed by the stage (pairs, columns, values or MB)
+  std::string unite; // Unit of the throughput: "pairs/s", "columns/s", "values/s" or "MB/s"
+};
+
+// Function to write a synthetic FASTA file: sequences derived from one random ancestral sequence (returns the length of the file)
+size_t genererAlignement(const parametresSynthese& p, const string& chemin)
+{
+    const char acides[] = "ACDEFGHIKLMNPQRSTVWY";
+    mt19937_64 generateur(p.graine);
+    uniform_int_distribution<int> tirageAcide(0, 19);
+    uniform_real_distribution<double> tirage(0.0, 1.0);
+    uniform_int_distribution<int> tirageLongueurGap(1, 8);
+
+    string ancetre(p.longueur, 'A');
+    for (char& c : ancetre)
+    {
+        c = acides[tirageAcide(generateur)];
+    }
+
+    ofstream fichier(chemin);
+    string sequence;
+    // A run of gaps starts at a site with probability gaps / (mean length of the runs)
+    double debutGap = p.gaps / 4.5;
+    for (int i = 0; i < p.nbSequences; i++)
+    {
+        sequence = ancetre;
+        for (size_t k = 0; k < p.longueur; k++)
+        {
+            if (tirage(generateur) < p.divergence)
+            {
+                sequence[k] = acides[tirageAcide(generateur)];
+            }
+            if (tirage(generateur) < debutGap)
+            {
+                size_t fin = min(p.longueur, k + tirageLongueurGap(generateur));
+                for (; k < fin; k++)
+                {
+                    sequence[k] = '-';
+                }
+                k--;
+            }
+        }
+        fichier << ">seq" << i + 1 << " synthetic\n";
+        // Lines of 60 residues, as the usual FASTA files
+        for (size_t k = 0; k < p.longueur; k += 60)
+        {
+            fichier.write(sequence.data() + k, min((size_t)60, p.longueur - k));
+            fichier << '\n';
+        }
+    }
+    fichier.close();
+    return filesystem::file_size(chemin);
+}
+
+// Function to get the best wall-clock time of repetitions of a stage (preparation is not timed)
+double chronometrer(int repetitions, const function<void()>& preparation, const function<void()>& etape)
+{
+    double meilleur = 0.0;
+    for (int r = 0; r < repetitions; r++)
+    {
+        preparation();
+        chrono::steady_clock::time_point debut = chrono::steady_clock::now();
+        etape();
+        double duree = chrono::duration<double>(chrono::steady_clock::now() - debut).count();
+        if ((r == 0) || (duree < meilleur))
+        {
+            meilleur = duree;
+        }
+    }
+    return meilleur;
+}
+
+// Function to read a list of integers separated by commas (ex. "500,1000,2000")
+vector<size_t> lireListe(const char* texte)
+{
+    vector<size_t> valeurs;
+    stringstream flux(texte);
+    string element;
+    while (getline(flux, element, ','))
+    {
+        if (!element.empty())
+        {
+            valeurs.push_back(stoul(element));
+        }
+    }
+    return valeurs;
+}
+
+// Function to read the times of a previous JSON result: key "n L stage", value: seconds
+map<string, double> lireReference(const string& chemin)
+{
+    map<string, double> temps;
+    ifstream fichier(chemin);
+    string ligne;
+    // One measure per line: {"n": ..., "L": ..., "stage": "...", "seconds": ..., ...}
+    auto champ = [](const string& ligne, const string& nom) -> string
+    {
+        size_t position = ligne.find("\"" + nom + "\": ");
+        if (position == string::npos)
+        {
+            return "";
+        }
+        position += nom.size() + 4;
+        size_t fin = ligne.find_first_of(",}", position);
+        string valeur = ligne.substr(position, fin - position);
+        if (!valeur.empty() && (valeur[0] == '"'))
+        {
+            valeur = valeur.substr(1, valeur.size() - 2);
+        }
+        return valeur;
+    };
+    while (getline(fichier, ligne))
+    {
+        string etape = champ(ligne, "stage");
+        if (!etape.empty())
+        {
+            temps[champ(ligne, "n") + " " + champ(ligne, "L") + " " + etape] = stod(champ(ligne, "seconds"));
+        }
+    }
+    return temps;
+}
+
+// Function to print the options of the benchmark
+void usageBenchmark(const char* programme)
+{
+    cout << "Usage: " << programme << " [options]\n"
+        << "Benchmark of Align on synthetic protein alignments: time and throughput of each stage on a grid of sizes.\n"
+        << "-n, --sequences LIST     Numbers of sequences, separated by commas [Default: 500,1000,2000].\n"
+        << "-L, --lengths LIST       Lengths of the alignments, separated by commas [Default: 200,1000].\n"
+        << "-g, --gaps FRACTION      Fraction of gaps in the sequences [Default: 0.1].\n"
+        << "-v, --divergence P       Probability of a substitution at each site from the ancestral sequence [Default: 0.3].\n"
+        << "-t, --threads N          Number of threads (0: all cores) [Default: 1].\n"
+        << "-e, --engine ENGINE      Counting engine: byte or bitsliced [Default: byte].\n"
+        << "-r, --repeats R          Repetitions of each stage, the best time is kept [Default: 3].\n"
+        << "-s, --seed S             Seed of the synthetic alignments [Default: 1].\n"
+        << "-d, --dir DIR            Directory of the temporary FASTA and output files [Default: temporary directory].\n"
+        << "-j, --json FILE          JSON file of the results [Default: bench.json].\n"
+        << "-b, --baseline FILE      JSON file of a previous build: the ratio of the times is printed for each stage.\n"
+        << endl;
+}
+
+int main(int argc, char** argv)
+{
+    vector<size_t> listeSequences = {500, 1000, 2000};
+    vector<size_t> listeLongueurs = {200, 1000};
+    double gaps = 0.1;
+    double divergenceSynthese = 0.3;
+    int nbThreads = 1;
+    string moteur = "byte";
+    int repetitions = 3;
+    uint64_t graine = 1;
+    string dossier = filesystem::temp_directory_path().string();
+    string fichierJson = "bench.json";
+    string fichierReference;
+
+    for (int a = 1; a < argc; a++)
+    {
+        string option = argv[a];
+        bool valeur = (a + 1 < argc);
+        if ((option == "-h") || (option == "--help"))
+        {
+            usageBenchmark(argv[0]);
+            return 0;
+        }else if (((option == "-n") || (option == "--sequences")) && valeur)
+        {
+            listeSequences = lireListe(argv[++a]);
+        }else if (((option == "-L") || (option == "--lengths")) && valeur)
+        {
+            listeLongueurs = lireListe(argv[++a]);
+        }else if (((option == "-g") || (option == "--gaps")) && valeur)
+        {
+            gaps = atof(argv[++a]);
+        }else if (((option == "-v") || (option == "--divergence")) && valeur)
+        {
+            divergenceSynthese = atof(argv[++a]);
+        }else if (((option == "-t") || (option == "--threads")) && valeur)
+        {
+            nbThreads = atoi(argv[++a]);
+        }else if (((option == "-e") || (option == "--engine")) && valeur)
+        {
+            moteur = argv[++a];
+        }else if (((option == "-r") || (option == "--repeats")) && valeur)
+        {
+            repetitions = max(1, atoi(argv[++a]));
+        }else if (((option == "-s") || (option == "--seed")) && valeur)
+        {
+            graine = stoull(argv[++a]);
+        }else if (((option == "-d") || (option == "--dir")) && valeur)
+        {
+            dossier = argv[++a];
+        }else if (((option == "-j") || (option == "--json")) && valeur)
+        {
+            fichierJson = argv[++a];
+        }else if (((option == "-b") || (option == "--baseline")) && valeur)
+        {
+            fichierReference = argv[++a];
+        }else{
+            cerr << "Error: unknown option " << option << ".\n";
+            usageBenchmark(argv[0]);
+            return -1;
+        }
+    }
+
+    map<string, double> reference;
+    if (!fichierReference.empty())
+    {
+        reference = lireReference(fichierReference);
+    }
+
+    // Temporary files of one process
+    string base = (filesystem::path(dossier) / ("align-bench-" + to_string(getpid()))).string();
+    string cheminFasta = base + ".fasta";
+    string cheminMat = base + ".mat.dist";
+    string cheminSeqs = base + ".seqs.dist";
+
+    // Methods of the transforms stage
+    vector<pair<string, string>> listeMethodes = {{"p", ""}, {"k", ""}, {"jc", ""}, {"pc", "LG"}, {"ei", "WAG"}};
+
+    vector<string> lignesJson;
+    cout << setw(7) << "n" << setw(7) << "L" << "  " << left << setw(20) << "stage" << right << setw(12) << "seconds"
+         << setw(16) << "throughput" << "  unit" << (reference.empty() ? "" : "         ratio") << "\n";
+
+    for (size_t n : listeSequences)
+    {
+        for (size_t L : listeLongueurs)
+        {
+            parametresSynthese p = {(int)n, L, gaps, divergenceSynthese, graine};
+            size_t tailleFasta = genererAlignement(p, cheminFasta);
+            double paires = (double)n * (n - 1) / 2;
+            double colonnes = (double)n * L;
+            vector<mesureEtape> mesures;
+
+            {
+                Fasta fichier;
+                Divergence divergence;
+                Methode methode;
+                unique_ptr<FastaMappe> fasta;
+
+                // Parse: mapping and reading of the FASTA file
+                double t = chronometrer(repetitions, [&]() { fasta.reset(); }, [&]() { fasta.reset(new FastaMappe(cheminFasta.c_str(), nbThreads)); });
+                mesures.push_back({"parse", t, tailleFasta / 1e6, "MB/s"});
+                const vector<vueFasta>& vues = fasta->sequences();
+
+                // Validation: number of sequences and same length of all sequences
+                t = chronometrer(repetitions, []() {}, [&]() { fichier.superieurAtrois(vues); fichier.tailleSequence(vues, vues.size()); });
+                mesures.push_back({"validation", t, colonnes, "columns/s"});
+
+                // Encoding of the alignment
+                unique_ptr<EncodedAlignment> alignement;
+                t = chronometrer(repetitions, [&]() { alignement.reset(); }, [&]() { alignement.reset(new EncodedAlignment(vues)); });
+                mesures.push_back({"encode", t, colonnes, "columns/s"});
+
+                // Removal of the columns with a gap (on a copy: the next stages keep the gaps)
+                unique_ptr<EncodedAlignment> copie;
+                t = chronometrer(repetitions, [&]() { copie.reset(new EncodedAlignment(vues)); }, [&]() { copie->filtrerColonnes(true, -1.0, nbThreads); });
+                mesures.push_back({"filtrerColonnes", t, colonnes, "columns/s"});
+                copie.reset();
+
+                // Distances estimation of all pairs
+                MatriceCondensee divergences;
+                t = chronometrer(repetitions, [&]() { divergences = MatriceCondensee(n); },
+                    [&]() { divergence.matriceDivergences(*alignement, divergences, nbThreads, moteur, DistanceEngine::descripteur("d")); });
+                mesures.push_back({"divergences", t, paires, "pairs/s"});
+
+                // Site patterns: compression of the columns, then distances estimation over the weighted patterns (on a copy)
+                copie.reset(new EncodedAlignment(vues));
+                t = chronometrer(repetitions, [&]() { copie.reset(new EncodedAlignment(vues)); }, [&]() { copie->compresserColonnes(nbThreads); });
+                mesures.push_back({"patterns", t, colonnes, "columns/s"});
+                MatriceCondensee divergencesMotifs;
+                t = chronometrer(repetitions, [&]() { divergencesMotifs = MatriceCondensee(n); },
+                    [&]() { divergence.matriceDivergences(*copie, divergencesMotifs, nbThreads, moteur, DistanceEngine::descripteur("d")); });
+                mesures.push_back({"divergences-patterns", t, paires, "pairs/s"});
+                copie.reset();
+
+                // Transforms of each method
+                MatriceCondensee distances(n);
+                for (const pair<string, string>& m : listeMethodes)
+                {
+                    descripteurMethode descripteur = DistanceEngine::descripteur(m.first, m.second);
+                    t = chronometrer(repetitions, []() {}, [&]() { methode.appliquer(descripteur, divergences, distances, nbThreads); });
+                    mesures.push_back({"method-" + Methode::suffixe(descripteur), t, paires, "values/s"});
+                }
+
+                // Writers of the text output files (throughput in MB of the written file)
+                t = chronometrer(repetitions, []() {}, [&]() { divergence.fichierMat(distances, *alignement, nbThreads, cheminMat); });
+                mesures.push_back({"write-mat", t, filesystem::file_size(cheminMat) / 1e6, "MB/s"});
+                t = chronometrer(repetitions, []() {}, [&]() { divergence.fichierDist(distances, *alignement, nbThreads, cheminSeqs); });
+                mesures.push_back({"write-seqs", t, filesystem::file_size(cheminSeqs) / 1e6, "MB/s"});
+            }
+
+            for (const mesureEtape& m : mesures)
+            {
+                double debit = (m.secondes > 0) ? m.volume / m.secondes : 0.0;
+                cout << setw(7) << n << setw(7) << L << "  " << left << setw(20) << m.etape << right << fixed << setprecision(6)
+                     << setw(12) << m.secondes << setprecision(1) << setw(16) << debit << "  " << left << setw(10) << m.unite << right;
+                auto trouve = reference.find(to_string(n) + " " + to_string(L) + " " + m.etape);
+                if ((trouve != reference.end()) && (trouve->second > 0))
+                {
+                    cout << setprecision(3) << setw(9) << m.secondes / trouve->second;
+                }
+                cout << "\n";
+
+                ostringstream ligne;
+                ligne << setprecision(9) << "    {\"n\": " << n << ", \"L\": " << L << ", \"stage\": \"" << m.etape << "\", \"seconds\": " << m.secondes
+                      << ", \"throughput\": " << debit << ", \"unit\": \"" << m.unite << "\"}";
+                lignesJson.push_back(ligne.str());
+            }
+        }
+    }
+    filesystem::remove(cheminFasta);
+    filesystem::remove(cheminMat);
+    filesystem::remove(cheminSeqs);
+
+    // JSON file: parameters of the run and one measure per line (read by --baseline)
+    ofstream json(fichierJson);
+    json << "{\n"
+         << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+         << "  \"date\": " << time(nullptr) << ",\n"
+         << "  \"threads\": " << nbThreads << ",\n"
+         << "  \"engine\": \"" << moteur << "\",\n"
+         << "  \"gaps\": " << gaps << ",\n"
+         << "  \"divergence\": " << divergenceSynthese << ",\n"
+         << "  \"repeats\": " << repetitions << ",\n"
+         << "  \"seed\": " << graine << ",\n"
+         << "  \"results\": [\n";
+    for (size_t k = 0; k < lignesJson.size(); k++)
+    {
+        json << lignesJson[k] << ((k + 1 < lignesJson.size()) ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    cout << "\nResults written in " << fichierJson << ".\n";
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatriceBinaire: Binary distance matrice file (mat.bin), versioned header, names table and condensed matrice, read with mmap.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "binaire.hpp"
+
+using namespace std;
+
+// MatriceBinaire Class constructor: map the file and read its header and names table
+MatriceBinaire::MatriceBinaire(const char* chemin)
+{
+    projection = NULL;
+    tailleFichier = 0;
+    nbSequences = 0;
+    octetsValeur = 0;
+    empreinteAlignement = 0;
+    valeurs = NULL;
+    valide = false;
+
+    int descripteur = open(chemin, O_RDONLY);
+    if (descripteur < 0)
+    {
+        return;
+    }
+    struct stat infos;
+    if ((fstat(descripteur, &infos) != 0) || ((size_t)infos.st_size < TAILLE_ENTETE_BINAIRE))
+    {
+        close(descripteur);
+        return;
+    }
+    tailleFichier = infos.st_size;
+    void* adresse = mmap(NULL, tailleFichier, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (adresse == MAP_FAILED)
+    {
+        tailleFichier = 0;
+        return;
+    }
+    projection = (const unsigned char*)adresse;
+
+    // Header
+    if ((memcmp(projection, MAGIQUE_BINAIRE, 8) != 0) || (lireLE(projection + 8, 4) != VERSION_BINAIRE))
+    {
+        return;
+    }
+    octetsValeur = lireLE(projection + 12, 4);
+    uint64_t n = lireLE(projection + 16, 8);
+    empreinteAlignement = lireLE(projection + 24, 8);
+    size_t positionNoms = lireLE(projection + 32, 8);
+    size_t positionMatrice = lireLE(projection + 40, 8);
+    nomMethode.assign((const char*)projection + 48, strnlen((const char*)projection + 48, TAILLE_NOM_BINAIRE));
+    nomModele.assign((const char*)projection + 64, strnlen((const char*)projection + 64, TAILLE_NOM_BINAIRE));
+    if (((octetsValeur != 4) && (octetsValeur != 8)) || (n > INT32_MAX) || (positionNoms > tailleFichier)
+        || (positionMatrice > tailleFichier))
+    {
+        return;
+    }
+    nbSequences = n;
+
+    // Names table
+    size_t position = positionNoms;
+    for (int i = 0; i < nbSequences; i++)
+    {
+        if (position + 12 > positionMatrice)
+        {
+            return;
+        }
+        empreintes.push_back(lireLE(projection + position, 8));
+        size_t longueur = lireLE(projection + position + 8, 4);
+        position += 12;
+        if (position + longueur > positionMatrice)
+        {
+            return;
+        }
+        noms.push_back(string_view((const char*)projection + position, longueur));
+        position += longueur;
+    }
+
+    // Condensed matrice: the file must contain the n(n-1)/2 distances (compared in values: n(n-1)/2 x 8 bytes can overflow 64 bits)
+    size_t nbValeurs = (n > 1) ? n * (n - 1) / 2 : 0;
+    if (nbValeurs > (tailleFichier - positionMatrice) / octetsValeur)
+    {
+        return;
+    }
+    valeurs = projection + positionMatrice;
+    valide = true;
+}
+
+// MatriceBinaire Class destructor: unmap the file
+MatriceBinaire::~MatriceBinaire()
+{
+    if (projection != NULL)
+    {
+        munmap((void*)projection, tailleFichier);
+    }
+}
+
+// Function to get the distance between sequences i and j in O(1) (0 on the diagonal)
+double MatriceBinaire::valeur(int i, int j) const
+{
+    if (i == j)
+    {
+        return 0.0;
+    }
+    if (i > j)
+    {
+        swap(i, j);
+    }
+    size_t index = (size_t)i * nbSequences - (size_t)i * (i + 1) / 2 + (j - i - 1);
+    if (octetsValeur == 4)
+    {
+        uint32_t bits = lireLE(valeurs + index * 4, 4);
+        float distance;
+        memcpy(&distance, &bits, 4);
+        return distance;
+    }
+    uint64_t bits = lireLE(valeurs + index * 8, 8);
+    double distance;
+    memcpy(&distance, &bits, 8);
+    return distance;
+}
+
+// Function to get the names table of the alignment (hash, length and header of each sequence), completed to end at a multiple of 8 bytes
+string MatriceBinaire::tableNoms(const EncodedAlignment& alignement, size_t positionNoms)
+{
+    string table;
+    for (int i = 0; i < alignement.nombreSequences(); i++)
+    {
+        unsigned char champs[12];
+        ecrireLE(champs, alignement.empreinteSequence(i), 8);
+        ecrireLE(champs + 8, alignement.entete(i).size(), 4);
+        table.append((const char*)champs, 12);
+        table.append(alignement.entete(i));
+    }
+    table.resize(((positionNoms + table.size() + 7) / 8) * 8 - positionNoms, '\0');
+    return table;
+}
+
+// Function to write the binary file of a condensed matrice (precision: 4 or 8 bytes per distance)
+bool MatriceBinaire::ecrire(const string& chemin, const MatriceCondensee& matrice, const EncodedAlignment& alignement,
+    const string& methode, const string& modele, uint32_t precision)
+{
+    ofstream fichier(chemin, ios::binary);
+    if (!fichier.is_open())
+    {
+        return false;
+    }
+    int n = matrice.nombreSequences();
+
+    // The matrice begins at a multiple of 8 bytes: it can be read in place after mmap
+    string noms = tableNoms(alignement, TAILLE_ENTETE_BINAIRE);
+    size_t positionMatrice = TAILLE_ENTETE_BINAIRE + noms.size();
+
+    // Header
+    unsigned char entete[TAILLE_ENTETE_BINAIRE] = {};
+    memcpy(entete, MAGIQUE_BINAIRE, 8);
+    ecrireLE(entete + 8, VERSION_BINAIRE, 4);
+    ecrireLE(entete + 12, precision, 4);
+    ecrireLE(entete + 16, n, 8);
+    ecrireLE(entete + 24, alignement.empreinte(), 8);
+    ecrireLE(entete + 32, TAILLE_ENTETE_BINAIRE, 8);
+    ecrireLE(entete + 40, positionMatrice, 8);
+    memcpy(entete + 48, methode.data(), min(methode.size(), TAILLE_NOM_BINAIRE));
+    memcpy(entete + 64, modele.data(), min(modele.size(), TAILLE_NOM_BINAIRE));
+    fichier.write((const char*)entete, TAILLE_ENTETE_BINAIRE);
+    fichier.write(noms.data(), noms.size());
+
+    // Condensed matrice, written by parts of 1M distances
+    const size_t TAILLE_PARTIE = (size_t)1 << 20;
+    vector<unsigned char> partie(TAILLE_PARTIE * precision);
+    const double* distances = matrice.donnees();
+    for (size_t debut = 0; debut < matrice.taille(); debut += TAILLE_PARTIE)
+    {
+        size_t fin = min(matrice.taille(), debut + TAILLE_PARTIE);
+        for (size_t k = debut; k < fin; k++)
+        {
+            if (precision == 4)
+            {
+                float distance = distances[k];
+                uint32_t bits;
+                memcpy(&bits, &distance, 4);
+                ecrireLE(partie.data() + (k - debut) * 4, bits, 4);
+            }else{
+                uint64_t bits;
+                memcpy(&bits, &distances[k], 8);
+                ecrireLE(partie.data() + (k - debut) * 8, bits, 8);
+            }
+        }
+        fichier.write((const char*)partie.data(), (fin - debut) * precision);
+        matrice.liberer(debut, fin);
+    }
+    fichier.close();
+    return !fichier.fail();
+}
@@ -0,0 +1,147 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatriceBinaire: Binary distance matrice file (mat.bin), versioned header, names table and condensed matrice, read with mmap.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+#include <string.h>
+
+#include "alignement.hpp" // alignement.hpp inclusion to use the headers and the hash of the alignment
+#include "matrice.hpp" // matrice.hpp inclusion to use condensed triangular matrice
+
+#ifndef BINAIRE_HPP
+#define BINAIRE_HPP
+
+/*
+ Format du fichier binaire (entiers et réels en little endian):
+   En-tête de 80 octets:
+     "ALIGNDM" + '\0'          8 octets
+     version                   uint32
+     précision                 uint32 (4: float32, 8: float64)
+     n                         uint64
+     empreinte de l'alignement uint64
+     position des noms         uint64
+     position de la matrice    uint64 (multiple de 8)
+     méthode                   16 octets (complétés par '\0')
+     modèle                    16 octets (complétés par '\0')
+   Table des noms: pour chaque séquence, empreinte uint64, longueur uint32 et en-tête
+   Matrice condensée: d(1,2),...,d(1,n), d(2,3),...,d(2,n),... (n(n-1)/2 valeurs)
+*/
+
+// Function to write an unsigned integer of nbOctets bytes in little endian
+inline void ecrireLE(unsigned char* octets, uint64_t valeur, int nbOctets)
+{
+  for (int o = 0; o < nbOctets; o++)
+  {
+    octets[o] = (valeur >> (8 * o)) & 0xff;
+  }
+}
+
+// Function to read an unsigned integer of nbOctets bytes in little endian
+inline uint64_t lireLE(const unsigned char* octets, int nbOctets)
+{
+  uint64_t valeur = 0;
+  for (int o = nbOctets - 1; o >= 0; o--)
+  {
+    valeur = (valeur << 8) | octets[o];
+  }
+  return valeur;
+}
+
+// Binary distance matrice file: magic, version and header length
+const char MAGIQUE_BINAIRE[8] = {'A', 'L', 'I', 'G', 'N', 'D', 'M', '\0'};
+const uint32_t VERSION_BINAIRE = 1;
+const size_t TAILLE_ENTETE_BINAIRE = 80;
+const size_t TAILLE_NOM_BINAIRE = 16; // Length of the method and model fields
+
+class MatriceBinaire
+{
+  private:
+    const unsigned char* projection; // Mapped file
+
+    size_t tailleFichier; // Length of the file
+
+    int nbSequences; // Number of sequences
+
+    uint32_t octetsValeur; // Precision: 4 (float32) or 8 (float64) bytes per distance
+
+    uint64_t empreinteAlignement; // Hash of the alignment
+
+    std::string nomMethode; // Evolutionary distances method
+
+    std::string nomModele; // Substitution model (Poisson Correction or Equal-Input)
+
+    std::vector<std::string_view> noms; // Headers, read in the mapped file
+
+    std::vector<uint64_t> empreintes; // Hash of each sequence
+
+    const unsigned char* valeurs; // Condensed matrice in the mapped file
+
+    bool valide; // True if the file is a binary distance matrice
+
+  public:
+    // MatriceBinaire Class constructor: map the file and read its header and names table
+    MatriceBinaire(const char* chemin);
+
+    // MatriceBinaire Class destructor: unmap the file
+    ~MatriceBinaire();
+
+    // The mapped file is not shared between two objects
+    MatriceBinaire(const MatriceBinaire&) = delete;
+    MatriceBinaire& operator=(const MatriceBinaire&) = delete;
+
+    // Function to check if the file is a valid binary distance matrice
+    bool ouvert() const { return valide; };
+
+    // Function to stock the number of sequences
+    int nombreSequences() const { return nbSequences; };
+
+    // Function to stock the precision: 4 (float32) or 8 (float64) bytes per distance
+    uint32_t precision() const { return octetsValeur; };
+
+    // Function to get the method and the substitution model
+    const std::string& methode() const { return nomMethode; };
+    const std::string& modele() const { return nomModele; };
+
+    // Function to get the hash of the alignment
+    uint64_t empreinte() const { return empreinteAlignement; };
+
+    // Function to get the header and the hash of sequence i
+    std::string_view nom(int i) const { return noms[i]; };
+    uint64_t empreinteSequence(int i) const { return empreintes[i]; };
+
+    // Function to get the distance between sequences i and j in O(1) (0 on the diagonal)
+    double valeur(int i, int j) const;
+
+    // Function to get the names table of the alignment (hash, length and header of each sequence), completed to end at a multiple of 8 bytes
+    static std::string tableNoms(const EncodedAlignment& alignement, size_t positionNoms);
+
+    /*
+      Function to write the binary file of a condensed matrice:
+        precision: 4 (float32) or 8 (float64) bytes per distance
+        Rows of the matrice are released after writing (matrice stocked in a file)
+    */
+    static bool ecrire(const std::string& chemin, const MatriceCondensee& matrice, const EncodedAlignment& alignement,
+      const std::string& methode, const std::string& modele, uint32_t precision);
+};
+#endif
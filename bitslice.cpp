@@ -0,0 +1,120 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class BitslicedAlignment: Encoded alignment stocked as one bitset per amino acid and one bitset of compared sites (popcount counting engine).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+
+#include "bitslice.hpp"
+
+using namespace std;
+
+// BitslicedAlignment Class constructor: one hot encoding of the encoded alignment
+BitslicedAlignment::BitslicedAlignment(const EncodedAlignment& alignement)
+{
+    nbSequences = alignement.nombreSequences();
+    nbMots = (alignement.taille() + 63) / 64;
+
+    // Codes 0 (gap) and 1 (unknown amino acid) have no bitset, they are never compared
+    nbPlans = 1 + (alignement.nombreCodes() - 2);
+    bits.assign((size_t)nbSequences * nbMots * nbPlans, 0);
+
+    for (int i = 0; i < nbSequences; i++)
+    {
+        const uint8_t* ligne = alignement.sequence(i);
+        uint64_t* sequenceBits = bits.data() + (size_t)i * nbMots * nbPlans;
+        for (size_t k = 0; k < alignement.taille(); k++)
+        {
+            uint8_t code = ligne[k];
+            if (code <= CODE_INCONNU)
+            {
+                continue;
+            }
+            uint64_t* mot = sequenceBits + (k / 64) * nbPlans;
+            uint64_t bit = (uint64_t)1 << (k % 64);
+            mot[0] |= bit; // Compared site
+            mot[code - 1] |= bit; // Amino acid of the site
+        }
+    }
+    journal() << "BitslicedAlignment Class constructor.\n";
+}
+
+// Function to count compared sites and equal amino acids of two sequences of bitsets (popcnt instruction if the processor has it)
+__attribute__((target_clones("popcnt", "default")))
+static comptes compterMots(const uint64_t* motsA, const uint64_t* motsB, size_t nbMots, int nbPlans)
+{
+    uint64_t sites = 0;
+    uint64_t egaux = 0;
+    for (size_t m = 0; m < nbMots; m++)
+    {
+        const uint64_t* a = motsA + m * nbPlans;
+        const uint64_t* b = motsB + m * nbPlans;
+        // Sites compared in both sequences
+        sites += __builtin_popcountll(a[0] & b[0]);
+        // Same amino acid in both sequences
+        for (int p = 1; p < nbPlans; p++)
+        {
+            egaux += __builtin_popcountll(a[p] & b[p]);
+        }
+    }
+    comptes c;
+    c.sites = sites;
+    c.substitutions = sites - egaux;
+    return c;
+}
+
+// Function to count substitutions and compared homologous sites between sequences i and j
+comptes BitslicedAlignment::compterPaire(int i, int j) const
+{
+    size_t tailleSequence = nbMots * nbPlans;
+    return compterMots(bits.data() + (size_t)i * tailleSequence, bits.data() + (size_t)j * tailleSequence, nbMots, nbPlans);
+}
+
+// Function to count substitutions and compared homologous sites between sequences i and j on the columns [debut, debut + taille), multiples of 64
+comptes BitslicedAlignment::compterSegment(int i, int j, size_t debut, size_t taille) const
+{
+    size_t tailleSequence = nbMots * nbPlans;
+    size_t premier = (debut / 64) * nbPlans;
+    return compterMots(bits.data() + (size_t)i * tailleSequence + premier, bits.data() + (size_t)j * tailleSequence + premier,
+        min(taille / 64, nbMots - debut / 64), nbPlans);
+}
+
+// MoteurComptage Class constructor: the bitsliced alignment is built once if the engine is "bitsliced"
+MoteurComptage::MoteurComptage(const EncodedAlignment& alignementEncode, const string& moteur) : alignement(alignementEncode)
+{
+    complet = false;
+    sitesComplets = 0;
+    if (moteur == "bitsliced")
+    {
+        alignementBits.reset(new BitslicedAlignment(alignement));
+    }else{
+        journal() << "Counting kernel: " << comptage.instructions() << ".\n";
+        // No gap and no unknown amino acid: the compared sites of all the pairs are the sites of the first sequence
+        if ((alignement.nombreSequences() > 0) && alignement.sansManquants())
+        {
+            complet = true;
+            sitesComplets = alignement.sitesCompares(0);
+        }
+    }
+}
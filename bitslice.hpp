@@ -0,0 +1,216 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class BitslicedAlignment: Encoded alignment stocked as one bitset per amino acid and one bitset of compared sites (popcount counting engine).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+
+#include "alignement.hpp" // alignement.hpp inclusion to use encoded sequences
+#include "comptage.hpp" // comptage.hpp inclusion to use struct comptes
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef BITSLICE_HPP
+#define BITSLICE_HPP
+
+/*
+ Chaque séquence est découpée en mots de 64 colonnes.
+ Pour chaque mot: un bitset des sites comparables (ni gap, ni "X"), puis un bitset par acide aminé présent dans l'alignement.
+ Les bitsets d'un même mot se suivent en mémoire pour lire les deux séquences d'une paire en une seule passe
+*/
+class BitslicedAlignment
+{
+  private:
+    int nbSequences; // Number of sequences
+
+    size_t nbMots; // Number of 64 bits words per bitset
+
+    int nbPlans; // Number of bitsets per word: 1 bitset of compared sites + 1 bitset per amino acid
+
+    std::vector<uint64_t> bits; // Bitsets of all sequences, sequence i begins at i*nbMots*nbPlans
+
+  public:
+    // BitslicedAlignment Class constructor: one hot encoding of the encoded alignment
+    BitslicedAlignment(const EncodedAlignment& alignement);
+
+    // BitslicedAlignment Class destructor
+    ~BitslicedAlignment()
+    {
+      journal() << "BitslicedAlignment Class destructor.\n";
+    };
+
+    // Function to count substitutions and compared homologous sites between sequences i and j
+    comptes compterPaire(int i, int j) const;
+
+    // Function to count substitutions and compared homologous sites between sequences i and j on the columns [debut, debut + taille), multiples of 64
+    comptes compterSegment(int i, int j, size_t debut, size_t taille) const;
+};
+
+// Number of columns counted between two checks of the substitutions of a bounded pair (multiple of 64)
+const size_t COLONNES_BORNEES = 1024;
+
+/*
+ Moteur de comptage choisi avec l'option --engine: comparaison SIMD des octets ("byte") ou bitsets par acide aminé ("bitsliced").
+ Le même moteur est utilisé par tous les parcours des paires (matrice, écriture en flux, mise à jour incrémentale)
+*/
+class MoteurComptage
+{
+  private:
+    const EncodedAlignment& alignement; // Encoded alignment
+
+    Comptage comptage; // SIMD kernel ("byte" engine)
+
+    std::unique_ptr<BitslicedAlignment> alignementBits; // One hot encoding of the alignment ("bitsliced" engine)
+
+    bool complet; // True if all the sites are compared ("byte" engine, no gap and no unknown amino acid in the alignment)
+
+    uint64_t sitesComplets; // Number of compared sites of all the pairs if complet is true
+
+  public:
+    // MoteurComptage Class constructor: the bitsliced alignment is built once if the engine is "bitsliced"
+    MoteurComptage(const EncodedAlignment& alignementEncode, const std::string& moteur);
+
+    // Function to check if all the sites are compared: the pairs can be counted with compterPaire<true>
+    bool tousCompares() const { return complet; };
+
+    /*
+      Function to count substitutions and compared homologous sites between sequences i and j, instantiated for the policy of the sites:
+        tousCompares false: sites with a gap or an unknown amino acid are not compared
+        tousCompares true (only if tousCompares() is true): only the substitutions are counted, all the pairs have the same compared sites
+    */
+    template <bool tousCompares>
+    comptes compterPaire(int i, int j) const
+    {
+      const std::vector<segmentColonnes>& segments = alignement.segmentsPonderes();
+      if (segments.empty())
+      {
+        if (alignementBits)
+        {
+          return alignementBits->compterPaire(i, j);
+        }
+        // The end of the rows are gaps: the whole rows are compared without a scalar end
+        if constexpr (tousCompares)
+        {
+          comptes c = comptage.compterDifferences(alignement.sequence(i), alignement.sequence(j), alignement.pasLigne());
+          c.sites = sitesComplets;
+          return c;
+        }
+        return comptage.compterPaire(alignement.sequence(i), alignement.sequence(j), alignement.pasLigne());
+      }
+      // Site patterns: counts of each segment times the weight of its columns
+      comptes total = {0, 0};
+      for (const segmentColonnes& segment : segments)
+      {
+        comptes c;
+        if (alignementBits)
+        {
+          c = alignementBits->compterSegment(i, j, segment.debut, segment.taille);
+        }else if constexpr (tousCompares)
+        {
+          c = comptage.compterDifferences(alignement.sequence(i) + segment.debut, alignement.sequence(j) + segment.debut, segment.taille);
+        }else{
+          c = comptage.compterPaire(alignement.sequence(i) + segment.debut, alignement.sequence(j) + segment.debut, segment.taille);
+        }
+        total.substitutions += segment.poids * c.substitutions;
+        total.sites += segment.poids * c.sites;
+      }
+      if constexpr (tousCompares)
+      {
+        if (!alignementBits)
+        {
+          total.sites = sitesComplets;
+        }
+      }
+      return total;
+    };
+
+    // Function to count substitutions and compared homologous sites between sequences i and j (sites with a gap or "X" are not compared)
+    comptes compterPaire(int i, int j) const
+    {
+      return compterPaire<false>(i, j);
+    };
+
+    /*
+      Function to count sequences i and j while their substitutions are at most limite, instantiated for the policy of the sites:
+        The columns are counted by windows of COLONNES_BORNEES columns (by segments with the site patterns): the counting stops
+        after the first window where the substitutions exceed limite, and false is returned (c has the counts of the read columns)
+    */
+    template <bool tousCompares>
+    bool compterPaireBornee(int i, int j, uint64_t limite, comptes& c) const
+    {
+      c = {0, 0};
+      const std::vector<segmentColonnes>& segments = alignement.segmentsPonderes();
+      if (segments.empty())
+      {
+        for (size_t debut = 0; debut < alignement.pasLigne(); debut += COLONNES_BORNEES)
+        {
+          size_t taille = std::min(COLONNES_BORNEES, alignement.pasLigne() - debut);
+          comptes fenetre;
+          if (alignementBits)
+          {
+            fenetre = alignementBits->compterSegment(i, j, debut, taille);
+          }else if constexpr (tousCompares)
+          {
+            fenetre = comptage.compterDifferences(alignement.sequence(i) + debut, alignement.sequence(j) + debut, taille);
+          }else{
+            fenetre = comptage.compterPaire(alignement.sequence(i) + debut, alignement.sequence(j) + debut, taille);
+          }
+          c.substitutions += fenetre.substitutions;
+          c.sites += fenetre.sites;
+          if (c.substitutions > limite)
+          {
+            return false;
+          }
+        }
+      }else{
+        for (const segmentColonnes& segment : segments)
+        {
+          comptes fenetre;
+          if (alignementBits)
+          {
+            fenetre = alignementBits->compterSegment(i, j, segment.debut, segment.taille);
+          }else if constexpr (tousCompares)
+          {
+            fenetre = comptage.compterDifferences(alignement.sequence(i) + segment.debut, alignement.sequence(j) + segment.debut, segment.taille);
+          }else{
+            fenetre = comptage.compterPaire(alignement.sequence(i) + segment.debut, alignement.sequence(j) + segment.debut, segment.taille);
+          }
+          c.substitutions += segment.poids * fenetre.substitutions;
+          c.sites += segment.poids * fenetre.sites;
+          if (c.substitutions > limite)
+          {
+            return false;
+          }
+        }
+      }
+      if constexpr (tousCompares)
+      {
+        if (!alignementBits)
+        {
+          c.sites = sitesComplets;
+        }
+      }
+      return true;
+    };
+};
+#endif
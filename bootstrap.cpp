@@ -0,0 +1,397 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class ReplicatsBootstrap: Bootstrap replicates of an encoded alignment, stocked as weights of the columns, and counting of pairs for all the replicates.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BOOTSTRAP_X86
+#include <immintrin.h>
+#endif
+
+#include "bootstrap.hpp"
+#include "parallele.hpp"
+
+using namespace std;
+
+// Number of replicates drawn by one task (the weights of a task fill whole cache lines of each column)
+const int REPLICATS_TACHE = 32;
+
+// Largest number of SIMD registers of 16 bits counters used for one pass over the listed columns
+const int REGISTRES_MAXIMUM = 8;
+
+// Number of columns of a tile (pasLigne is a multiple of 64): the weights of a tile are read from the L1 cache for all the pairs of a group
+const size_t COLONNES_TUILE = 64;
+
+// Number of pairs of a group: the pairs of a group share the weights of each tile
+const int PAIRES_GROUPE = 16;
+
+// Function to add the columns of the bits of a mask to a list (debut: column of the bit 0)
+static inline void listerBits(uint64_t masque, size_t debut, uint32_t* colonnes, size_t& nbColonnes)
+{
+    while (masque != 0)
+    {
+        colonnes[nbColonnes++] = debut + __builtin_ctzll(masque);
+        masque &= masque - 1;
+    }
+}
+
+// Scalar kernel: list the different columns and the columns compared in seq1 only, site by site
+static void listerScalaire(const uint8_t* seq1, const uint8_t* seq2, size_t taille, uint32_t* differents, size_t& nbDifferents,
+    uint32_t* absents, size_t& nbAbsents)
+{
+    for (size_t k = 0; k < taille; k++)
+    {
+        if (seq1[k] <= CODE_INCONNU)
+        {
+            continue;
+        }
+        if (seq2[k] <= CODE_INCONNU)
+        {
+            absents[nbAbsents++] = k;
+        }else if (seq1[k] != seq2[k])
+        {
+            differents[nbDifferents++] = k;
+        }
+    }
+}
+
+// Scalar kernel: add the weights of the listed columns to the 16 bits counters of a group of largeur replicates
+static void accumulerScalaire(const uint16_t* poids, size_t largeur, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes)
+{
+    for (size_t c = 0; c < nbColonnes; c++)
+    {
+        const uint16_t* ligne = poids + colonnes[c] * largeur;
+        for (size_t r = 0; r < largeur; r++)
+        {
+            sommes[r] += ligne[r];
+        }
+    }
+}
+
+#ifdef BOOTSTRAP_X86
+
+/*
+ SIMD kernels: the masks of a block of 32 (AVX2) or 64 (AVX-512) columns give the listed columns,
+ then the weights of the listed columns are added to N registers of 16 bits counters (16 or 32 replicates per register),
+ loaded before the columns of the tile and stored after them
+*/
+
+// AVX2 kernel: list the columns by blocks of 32 columns
+__attribute__((target("avx2")))
+static void listerAVX2(const uint8_t* seq1, const uint8_t* seq2, size_t taille, uint32_t* differents, size_t& nbDifferents,
+    uint32_t* absents, size_t& nbAbsents)
+{
+    const __m256i inconnu = _mm256_set1_epi8(CODE_INCONNU);
+    for (size_t k = 0; k < taille; k += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(seq1 + k));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(seq2 + k));
+        // min(code, CODE_INCONNU) == code if code <= CODE_INCONNU (unsigned comparison)
+        uint32_t valideA = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(a, inconnu), a));
+        uint32_t valideB = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(b, inconnu), b));
+        uint32_t egal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        listerBits(valideA & valideB & ~egal, k, differents, nbDifferents);
+        listerBits(valideA & ~valideB, k, absents, nbAbsents);
+    }
+}
+
+// AVX2 kernel: add the weights of the listed columns to N registers of 16 replicates
+template <int N>
+__attribute__((target("avx2")))
+static void accumulerBlocAVX2(const uint16_t* poids, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes)
+{
+    __m256i registres[N];
+#pragma GCC unroll 8
+    for (int n = 0; n < N; n++)
+    {
+        registres[n] = _mm256_loadu_si256((const __m256i*)(sommes + 16 * n));
+    }
+    for (size_t c = 0; c < nbColonnes; c++)
+    {
+        const uint16_t* ligne = poids + colonnes[c] * (16 * N);
+        // The loop of the registers is unrolled: the counters stay in registers
+#pragma GCC unroll 8
+        for (int n = 0; n < N; n++)
+        {
+            registres[n] = _mm256_add_epi16(registres[n], _mm256_loadu_si256((const __m256i*)(ligne + 16 * n)));
+        }
+    }
+#pragma GCC unroll 8
+    for (int n = 0; n < N; n++)
+    {
+        _mm256_storeu_si256((__m256i*)(sommes + 16 * n), registres[n]);
+    }
+}
+
+// AVX2 kernel: add the weights of the listed columns to the counters of a group of largeur replicates (at most 128)
+__attribute__((target("avx2")))
+static void accumulerAVX2(const uint16_t* poids, size_t largeur, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes)
+{
+    static void (*const blocs[REGISTRES_MAXIMUM + 1])(const uint16_t*, const uint32_t*, size_t, uint16_t*) = {nullptr,
+        accumulerBlocAVX2<1>, accumulerBlocAVX2<2>, accumulerBlocAVX2<3>, accumulerBlocAVX2<4>,
+        accumulerBlocAVX2<5>, accumulerBlocAVX2<6>, accumulerBlocAVX2<7>, accumulerBlocAVX2<8>};
+    blocs[largeur / 16](poids, colonnes, nbColonnes, sommes);
+}
+
+// AVX-512 kernel: list the columns by blocks of 64 columns, comparisons give directly 64 bits masks
+__attribute__((target("avx512f,avx512bw")))
+static void listerAVX512(const uint8_t* seq1, const uint8_t* seq2, size_t taille, uint32_t* differents, size_t& nbDifferents,
+    uint32_t* absents, size_t& nbAbsents)
+{
+    const __m512i inconnu = _mm512_set1_epi8(CODE_INCONNU);
+    for (size_t k = 0; k < taille; k += 64)
+    {
+        __m512i a = _mm512_loadu_si512((const void*)(seq1 + k));
+        __m512i b = _mm512_loadu_si512((const void*)(seq2 + k));
+        uint64_t valideA = (uint64_t)_mm512_cmpgt_epu8_mask(a, inconnu);
+        uint64_t valideB = (uint64_t)_mm512_cmpgt_epu8_mask(b, inconnu);
+        uint64_t different = (uint64_t)_mm512_cmpneq_epi8_mask(a, b);
+        listerBits(valideA & valideB & different, k, differents, nbDifferents);
+        listerBits(valideA & ~valideB, k, absents, nbAbsents);
+    }
+}
+
+// AVX-512 kernel: add the weights of the listed columns to N registers of 32 replicates
+template <int N>
+__attribute__((target("avx512f,avx512bw")))
+static void accumulerBlocAVX512(const uint16_t* poids, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes)
+{
+    __m512i registres[N];
+#pragma GCC unroll 8
+    for (int n = 0; n < N; n++)
+    {
+        registres[n] = _mm512_loadu_si512((const void*)(sommes + 32 * n));
+    }
+    for (size_t c = 0; c < nbColonnes; c++)
+    {
+        const uint16_t* ligne = poids + colonnes[c] * (32 * N);
+        // The loop of the registers is unrolled: the counters stay in registers
+#pragma GCC unroll 8
+        for (int n = 0; n < N; n++)
+        {
+            registres[n] = _mm512_add_epi16(registres[n], _mm512_loadu_si512((const void*)(ligne + 32 * n)));
+        }
+    }
+#pragma GCC unroll 8
+    for (int n = 0; n < N; n++)
+    {
+        _mm512_storeu_si512((void*)(sommes + 32 * n), registres[n]);
+    }
+}
+
+// AVX-512 kernel: add the weights of the listed columns to the counters of a group of largeur replicates (at most 256)
+__attribute__((target("avx512f,avx512bw")))
+static void accumulerAVX512(const uint16_t* poids, size_t largeur, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes)
+{
+    static void (*const blocs[REGISTRES_MAXIMUM + 1])(const uint16_t*, const uint32_t*, size_t, uint16_t*) = {nullptr,
+        accumulerBlocAVX512<1>, accumulerBlocAVX512<2>, accumulerBlocAVX512<3>, accumulerBlocAVX512<4>,
+        accumulerBlocAVX512<5>, accumulerBlocAVX512<6>, accumulerBlocAVX512<7>, accumulerBlocAVX512<8>};
+    blocs[largeur / 32](poids, colonnes, nbColonnes, sommes);
+}
+
+#endif
+
+// Function to add the 16 bits counters of the pairs of a group to their totals and reset them
+static void viderSommes(vector<uint16_t>& sommes, size_t largeurGroupe, int nbPaires, size_t largeur, uint32_t* totaux, size_t pas)
+{
+    for (int p = 0; p < nbPaires; p++)
+    {
+        uint16_t* somme = sommes.data() + p * largeurGroupe;
+        uint32_t* total = totaux + p * pas;
+        for (size_t r = 0; r < largeur; r++)
+        {
+            total[r] += somme[r];
+            somme[r] = 0;
+        }
+    }
+}
+
+// ReplicatsBootstrap Class constructor: draw the columns of the replicates on nbThreads threads and choose the kernels for the processor
+ReplicatsBootstrap::ReplicatsBootstrap(const EncodedAlignment& alignementEncode, int replicats, uint64_t graine, int nbThreads)
+    : alignement(alignementEncode)
+{
+    nbReplicats = max(replicats, 0);
+    pas = ((size_t)nbReplicats + 31) / 32 * 32;
+    size_t longueur = alignement.taille();
+    int nbSequences = alignement.nombreSequences();
+    Parallele parallele(nbThreads);
+
+    jeuInstructions = "scalar";
+    largeurGroupe = 32 * REGISTRES_MAXIMUM;
+    noyauColonnes = listerScalaire;
+    noyauPoids = accumulerScalaire;
+#ifdef BOOTSTRAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+    {
+        jeuInstructions = "avx512";
+        noyauColonnes = listerAVX512;
+        noyauPoids = accumulerAVX512;
+    }else if (__builtin_cpu_supports("avx2"))
+    {
+        jeuInstructions = "avx2";
+        largeurGroupe = 16 * REGISTRES_MAXIMUM;
+        noyauColonnes = listerAVX2;
+        noyauPoids = accumulerAVX2;
+    }
+#endif
+    // The columns of the end of the rows (gaps) have the weight 0: the rows are read by whole tiles
+    poids.assign(alignement.pasLigne() * pas, 0);
+
+    /*
+    Columns of each replicate: longueur draws with replacement, the weight of a column is its number of draws
+    (the weights are stocked on 16 bits: about a Poisson law of mean 1)
+    */
+    if (longueur > 0)
+    {
+        parallele.executer((nbReplicats + REPLICATS_TACHE - 1) / REPLICATS_TACHE, [&](size_t tache)
+        {
+            int fin = min(nbReplicats, (int)(tache + 1) * REPLICATS_TACHE);
+            for (int r = tache * REPLICATS_TACHE; r < fin; r++)
+            {
+                seed_seq sequenceGraine = {(uint32_t)graine, (uint32_t)(graine >> 32), (uint32_t)r};
+                mt19937_64 generateur(sequenceGraine);
+                uniform_int_distribution<size_t> colonne(0, longueur - 1);
+                for (size_t tirage = 0; tirage < longueur; tirage++)
+                {
+                    poids[position(colonne(generateur), r)]++;
+                }
+            }
+        });
+    }
+
+    /*
+    The weights of a replicate sum to longueur: below 65536 columns, the 16 bits counters never overflow.
+    Above, the counters are added to the totals after a number of tiles whose weights can't exceed 65535
+    */
+    uint32_t tuileMaximum = 1;
+    for (size_t debut = 0; debut < longueur; debut += COLONNES_TUILE)
+    {
+        vector<uint32_t> tuile(pas, 0);
+        for (size_t k = debut; k < min(longueur, debut + COLONNES_TUILE); k++)
+        {
+            for (size_t r = 0; r < pas; r++)
+            {
+                tuile[r] += poids[position(k, r)];
+            }
+        }
+        tuileMaximum = max(tuileMaximum, *max_element(tuile.begin(), tuile.end()));
+    }
+    tuilesBloc = (longueur <= 65535) ? SIZE_MAX : max((size_t)1, (size_t)(65535 / tuileMaximum));
+
+    // Weighted compared sites of each sequence: sum of the weights of its compared columns
+    sitesSequences.assign((size_t)nbSequences * pas, 0);
+    parallele.executer(nbSequences, [&](size_t i)
+    {
+        const uint8_t* sequence = alignement.sequence(i);
+        uint32_t* sites = sitesSequences.data() + i * pas;
+        for (size_t base = 0; base < pas; base += largeurGroupe)
+        {
+            size_t largeur = min(largeurGroupe, pas - base);
+            for (size_t k = 0; k < longueur; k++)
+            {
+                if (sequence[k] > CODE_INCONNU)
+                {
+                    const uint16_t* ligne = poids.data() + position(k, base);
+                    for (size_t r = 0; r < largeur; r++)
+                    {
+                        sites[base + r] += ligne[r];
+                    }
+                }
+            }
+        }
+    });
+}
+
+/*
+ Function to count substitutions and compared homologous sites between sequence i and sequences premier to dernier-1 in all the replicates
+ (pasReplicats() values for each pair: pair premier+p begins at p*pasReplicats())
+*/
+void ReplicatsBootstrap::compterPaires(int i, int premier, int dernier, uint32_t* substitutions, uint32_t* sites) const
+{
+    // Lists of the columns of a tile and 16 bits counters of a group of pairs, for each thread
+    thread_local vector<uint32_t> differents;
+    thread_local vector<uint32_t> absents;
+    thread_local vector<uint16_t> sommesDifferents;
+    thread_local vector<uint16_t> sommesAbsents;
+    thread_local vector<uint32_t> totauxAbsents;
+    differents.resize(COLONNES_TUILE);
+    absents.resize(COLONNES_TUILE);
+    sommesDifferents.assign(PAIRES_GROUPE * largeurGroupe, 0);
+    sommesAbsents.assign(PAIRES_GROUPE * largeurGroupe, 0);
+    totauxAbsents.resize(PAIRES_GROUPE * pas);
+
+    const uint8_t* sequenceI = alignement.sequence(i);
+    const uint32_t* sitesI = sitesSequences.data() + (size_t)i * pas;
+    size_t pasLigne = alignement.pasLigne();
+    for (int groupe = premier; groupe < dernier; groupe += PAIRES_GROUPE)
+    {
+        int nbPaires = min(PAIRES_GROUPE, dernier - groupe);
+        uint32_t* totauxDifferents = substitutions + (size_t)(groupe - premier) * pas;
+        fill(totauxDifferents, totauxDifferents + nbPaires * pas, 0);
+        fill(totauxAbsents.begin(), totauxAbsents.end(), 0);
+
+        /*
+        Replicates by groups of largeurGroupe (counters in registers), then columns by tiles:
+        the columns of a tile are listed for each pair of the group and their weights are read from the L1 cache
+        */
+        for (size_t base = 0; base < pas; base += largeurGroupe)
+        {
+            size_t largeur = min(largeurGroupe, pas - base);
+            size_t nbTuiles = 0;
+            for (size_t debut = 0; debut < pasLigne; debut += COLONNES_TUILE)
+            {
+                const uint16_t* poidsTuile = poids.data() + position(debut, base);
+                for (int p = 0; p < nbPaires; p++)
+                {
+                    size_t nbDifferents = 0;
+                    size_t nbAbsents = 0;
+                    noyauColonnes(sequenceI + debut, alignement.sequence(groupe + p) + debut, COLONNES_TUILE, differents.data(), nbDifferents,
+                      absents.data(), nbAbsents);
+                    noyauPoids(poidsTuile, largeur, differents.data(), nbDifferents, sommesDifferents.data() + p * largeurGroupe);
+                    noyauPoids(poidsTuile, largeur, absents.data(), nbAbsents, sommesAbsents.data() + p * largeurGroupe);
+                }
+                if ((++nbTuiles == tuilesBloc) || (debut + COLONNES_TUILE >= pasLigne))
+                {
+                    viderSommes(sommesDifferents, largeurGroupe, nbPaires, largeur, totauxDifferents + base, pas);
+                    viderSommes(sommesAbsents, largeurGroupe, nbPaires, largeur, totauxAbsents.data() + base, pas);
+                    nbTuiles = 0;
+                }
+            }
+        }
+
+        // Compared sites: weighted sites of sequence i minus the weights of the columns absent of the other sequence
+        for (int p = 0; p < nbPaires; p++)
+        {
+            uint32_t* sitesPaire = sites + (size_t)(groupe - premier + p) * pas;
+            for (size_t r = 0; r < pas; r++)
+            {
+                sitesPaire[r] = sitesI[r] - totauxAbsents[p * pas + r];
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class ReplicatsBootstrap: Bootstrap replicates of an encoded alignment, stocked as weights of the columns, and counting of pairs for all the replicates.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+
+#include "alignement.hpp" // alignement.hpp inclusion to use encoded sequences
+
+#ifndef BOOTSTRAP_HPP
+#define BOOTSTRAP_HPP
+
+/*
+ Réplicats bootstrap d'un alignement: chaque réplicat tire L colonnes avec remise parmi les L colonnes de l'alignement.
+ Un réplicat n'est pas écrit: il est stocké comme le poids de chaque colonne (nombre de tirages de la colonne).
+ Les réplicats sont rangés par groupes de 256 (AVX-512) ou 128 (AVX2) réplicats, et les poids d'un groupe par colonne
+ (les réplicats du groupe pour une colonne se suivent, les colonnes d'un groupe se suivent). Les colonnes sont parcourues par tuiles
+ de 64 colonnes pour un groupe de paires: les poids d'une tuile restent dans le cache L1 pour toutes les paires du groupe.
+ Pour une paire, les colonnes différentes et les colonnes comparées dans la première séquence seulement d'une tuile sont listées,
+ puis leurs poids sont additionnés pour tous les réplicats à la fois (compteurs de 16 bits dans les registres SIMD):
+   substitutions = somme des poids des colonnes différentes
+   sites = sites pondérés de la première séquence - somme des poids des colonnes absentes de la seconde
+*/
+class ReplicatsBootstrap
+{
+  private:
+    const EncodedAlignment& alignement; // Encoded alignment (after the gap policy)
+
+    int nbReplicats; // Number of replicates
+
+    size_t pas; // Number of weights of a column: nbReplicats rounded to 32 (the weights of the end are 0)
+
+    std::vector<uint16_t> poids; // Weight of each column in each replicate, by groups of largeurGroupe replicates (see position)
+
+    std::vector<uint32_t> sitesSequences; // Weighted compared sites of each sequence in each replicate, sequence i begins at i*pas
+
+    size_t largeurGroupe; // Number of replicates whose counters are kept in the SIMD registers
+
+    size_t tuilesBloc; // Number of tiles added in the 16 bits counters before they are added to the totals (no overflow)
+
+    std::string jeuInstructions; // Name of the instruction set used by the kernels
+
+    // Kernel to list the different columns and the columns compared in seq1 only (taille multiple of 64)
+    void (*noyauColonnes)(const uint8_t* seq1, const uint8_t* seq2, size_t taille, uint32_t* differents, size_t& nbDifferents,
+      uint32_t* absents, size_t& nbAbsents);
+
+    // Kernel to add the weights of the listed columns to the 16 bits counters of a group of largeur replicates (multiple of 32, at most largeurGroupe)
+    void (*noyauPoids)(const uint16_t* poids, size_t largeur, const uint32_t* colonnes, size_t nbColonnes, uint16_t* sommes);
+
+    /*
+      Function to get the position of the weight of column k in replicate r: the group of r begins at base*pasLigne,
+      and its columns are stocked one after the other with the weights of the largeur replicates of the group
+    */
+    size_t position(size_t k, size_t r) const
+    {
+      size_t base = r / largeurGroupe * largeurGroupe;
+      return base * alignement.pasLigne() + k * std::min(largeurGroupe, pas - base) + (r - base);
+    };
+
+  public:
+    /*
+      ReplicatsBootstrap Class constructor: draw the columns of the replicates on nbThreads threads and choose the kernels for the processor
+        The columns of replicate r are drawn by a generator seeded with (graine, r): the replicates don't depend on the number of threads
+    */
+    ReplicatsBootstrap(const EncodedAlignment& alignementEncode, int replicats, uint64_t graine, int nbThreads = 1);
+
+    // Function to stock the number of replicates
+    int nombre() const { return nbReplicats; };
+
+    // Function to stock the number of counts of a pair given by compterPaires (multiple of 32)
+    size_t pasReplicats() const { return pas; };
+
+    // Function to stock the name of the instruction set used by the kernels (scalar, avx2 or avx512)
+    const std::string& instructions() const { return jeuInstructions; };
+
+    // Function to get the weight of column k in replicate r
+    uint16_t poidsColonne(size_t k, int r) const { return poids[position(k, r)]; };
+
+    /*
+      Function to count substitutions and compared homologous sites between sequence i and sequences premier to dernier-1 in all the replicates
+        pasReplicats() values for each pair: the counts of the pair of sequence premier+p begin at p*pasReplicats()
+    */
+    void compterPaires(int i, int premier, int dernier, uint32_t* substitutions, uint32_t* sites) const;
+};
+#endif
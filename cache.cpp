@@ -0,0 +1,234 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class CachePaires: Cache file of the substitutions and compared sites of each pair of sequences, keyed by the hash of the alignment and the gap policy.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cache.hpp"
+#include "journal.hpp"
+
+using namespace std;
+
+// Function to get the code of the gap policy (removal of the columns with a gap, threshold of gaps and X in %, negative: no threshold)
+uint32_t CachePaires::politiqueGaps(bool sansGaps, double seuil)
+{
+    uint32_t politique = sansGaps ? 1 : 0;
+    if (seuil >= 0.0)
+    {
+        politique |= (1 + (uint32_t)llround(min(seuil, 100.0) * 100.0)) << 1;
+    }
+    return politique;
+}
+
+// CachePaires Class constructor: open the cache file of the alignment in dossier, or create it if it doesn't exist
+CachePaires::CachePaires(const string& dossier, int n, size_t longueur, uint64_t empreinte, uint32_t politique)
+{
+    projection = NULL;
+    tailleFichier = 0;
+    nbPaires = (n > 1) ? (size_t)n * (n - 1) / 2 : 0;
+    lecture = false;
+    ecriture = false;
+
+    // Counts of 2 bytes if they can't be greater than 65535
+    octetsCompte = (longueur < 65536) ? 2 : 4;
+    if (longueur > UINT32_MAX)
+    {
+        journal() << "Alignment too long for the pair counts cache.\n";
+        return;
+    }
+
+    // File name: hash of the alignment and gap policy
+    char nom[64];
+    if ((politique >> 1) == 0)
+    {
+        snprintf(nom, sizeof(nom), "%016llx-%s.cnt", (unsigned long long)empreinte, (politique & 1) ? "nogaps" : "gaps");
+    }else{
+        // Threshold of the columns in hundredths of % (ex. "-gaps-max5000": columns with more than 50 % of gaps and X removed)
+        snprintf(nom, sizeof(nom), "%016llx-%s-max%u.cnt", (unsigned long long)empreinte, (politique & 1) ? "nogaps" : "gaps", (politique >> 1) - 1);
+    }
+    chemin = dossier + "/" + nom;
+
+    // Cache directory created with its parents if it doesn't exist, the cache isn't used if it can't be created
+    error_code erreur;
+    filesystem::create_directories(dossier, erreur);
+    if (erreur)
+    {
+        cerr << "Error: the cache directory " << dossier << " can't be created (" << erreur.message() << "), the cache isn't used.\n";
+        return;
+    }
+    size_t tailleAttendue = TAILLE_ENTETE_CACHE + nbPaires * 2 * octetsCompte;
+
+    // Existing cache file: the header must be the one of the alignment
+    int descripteur = open(chemin.c_str(), O_RDONLY);
+    if (descripteur >= 0)
+    {
+        struct stat infos;
+        if ((fstat(descripteur, &infos) == 0) && ((size_t)infos.st_size == tailleAttendue))
+        {
+            void* adresse = mmap(NULL, tailleAttendue, PROT_READ, MAP_SHARED, descripteur, 0);
+            if (adresse != MAP_FAILED)
+            {
+                const unsigned char* entete = (const unsigned char*)adresse;
+                if ((memcmp(entete, MAGIQUE_CACHE, 8) == 0) && (lireLE(entete + 8, 4) == VERSION_CACHE)
+                    && (lireLE(entete + 12, 4) == octetsCompte) && (lireLE(entete + 16, 8) == (uint64_t)n)
+                    && (lireLE(entete + 24, 8) == empreinte) && (lireLE(entete + 32, 4) == politique)
+                    && (lireLE(entete + 40, 8) == longueur))
+                {
+                    projection = (unsigned char*)adresse;
+                    tailleFichier = tailleAttendue;
+                    lecture = true;
+                    madvise(adresse, tailleAttendue, MADV_SEQUENTIAL);
+                }else{
+                    munmap(adresse, tailleAttendue);
+                }
+            }
+        }
+        close(descripteur);
+    }
+    if (lecture)
+    {
+        journal() << "Pair counts read from the cache file " << chemin << ".\n";
+        return;
+    }
+
+    // New cache file: written in a temporary file, renamed when all counts are written
+    string temporaire = chemin + ".tmp";
+    descripteur = open(temporaire.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((descripteur < 0) || (ftruncate(descripteur, tailleAttendue) != 0))
+    {
+        if (descripteur >= 0)
+        {
+            close(descripteur);
+            unlink(temporaire.c_str());
+        }
+        journal() << "The cache file " << chemin << " can't be created.\n";
+        return;
+    }
+    void* adresse = mmap(NULL, tailleAttendue, PROT_READ | PROT_WRITE, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (adresse == MAP_FAILED)
+    {
+        unlink(temporaire.c_str());
+        journal() << "The cache file " << chemin << " can't be created.\n";
+        return;
+    }
+    projection = (unsigned char*)adresse;
+    tailleFichier = tailleAttendue;
+    ecriture = true;
+
+    memcpy(projection, MAGIQUE_CACHE, 8);
+    ecrireLE(projection + 8, VERSION_CACHE, 4);
+    ecrireLE(projection + 12, octetsCompte, 4);
+    ecrireLE(projection + 16, n, 8);
+    ecrireLE(projection + 24, empreinte, 8);
+    ecrireLE(projection + 32, politique, 4);
+    ecrireLE(projection + 36, 0, 4);
+    ecrireLE(projection + 40, longueur, 8);
+    journal() << "Pair counts written in the cache file " << chemin << ".\n";
+}
+
+// CachePaires Class destructor: unmap the file (a cache file not finished is removed)
+CachePaires::~CachePaires()
+{
+    if (ecriture)
+    {
+        unlink((chemin + ".tmp").c_str());
+    }
+    fermer();
+}
+
+// Function to unmap the file
+void CachePaires::fermer()
+{
+    if (projection != NULL)
+    {
+        munmap(projection, tailleFichier);
+    }
+    projection = NULL;
+}
+
+// Function to read the counts of a pair
+comptes CachePaires::lire(size_t paire) const
+{
+    const unsigned char* champs = projection + TAILLE_ENTETE_CACHE + paire * 2 * octetsCompte;
+    comptes c;
+    c.substitutions = lireLE(champs, octetsCompte);
+    c.sites = lireLE(champs + octetsCompte, octetsCompte);
+    return c;
+}
+
+// Function to write the counts of a pair
+void CachePaires::stocker(size_t paire, const comptes& c)
+{
+    unsigned char* champs = projection + TAILLE_ENTETE_CACHE + paire * 2 * octetsCompte;
+    ecrireLE(champs, c.substitutions, octetsCompte);
+    ecrireLE(champs + octetsCompte, c.sites, octetsCompte);
+}
+
+// Function to write the counts [debut, fin) in the file and release them from memory
+void CachePaires::liberer(size_t debut, size_t fin) const
+{
+    if ((projection == NULL) || (fin <= debut))
+    {
+        return;
+    }
+    // Only the pages completely inside the counts [debut, fin) are released
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t premierOctet = TAILLE_ENTETE_CACHE + debut * 2 * octetsCompte;
+    size_t dernierOctet = TAILLE_ENTETE_CACHE + fin * 2 * octetsCompte;
+    premierOctet = ((premierOctet + page - 1) / page) * page;
+    dernierOctet = (dernierOctet / page) * page;
+    if (dernierOctet > premierOctet)
+    {
+        if (ecriture)
+        {
+            msync(projection + premierOctet, dernierOctet - premierOctet, MS_ASYNC);
+        }
+        madvise(projection + premierOctet, dernierOctet - premierOctet, MADV_DONTNEED);
+    }
+}
+
+// Function to finish the cache file: it can be used by the next runs
+void CachePaires::terminer()
+{
+    if (!ecriture)
+    {
+        return;
+    }
+    msync(projection, tailleFichier, MS_SYNC);
+    fermer();
+    if (rename((chemin + ".tmp").c_str(), chemin.c_str()) != 0)
+    {
+        unlink((chemin + ".tmp").c_str());
+        journal() << "The cache file " << chemin << " can't be created.\n";
+    }
+    ecriture = false;
+}
@@ -0,0 +1,105 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class CachePaires: Cache file of the substitutions and compared sites of each pair of sequences, keyed by the hash of the alignment and the gap policy.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+
+#include "comptage.hpp" // comptage.hpp inclusion to use struct comptes
+#include "binaire.hpp" // binaire.hpp inclusion to read and write little endian integers
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+/*
+ Format du fichier cache (little endian):
+   En-tête de 48 octets:
+     "ALIGNPC" + '\0'            8 octets
+     version                     uint32
+     octets par compte           uint32 (2 si l'alignement a moins de 65536 colonnes, sinon 4)
+     n                           uint64
+     empreinte de l'alignement   uint64 (avant la suppression des gaps)
+     politique des gaps          uint32 (bit 0: colonnes avec gaps supprimées, bits suivants: 1 + seuil de gaps et X en centièmes de %, 0 sans seuil)
+     réservé                     uint32
+     longueur de l'alignement    uint64 (après la politique des gaps)
+   Comptes: substitutions puis sites comparés de chaque paire, dans l'ordre des distances
+ Les distances de toutes les méthodes ne dépendent que de ces comptes
+*/
+const char MAGIQUE_CACHE[8] = {'A', 'L', 'I', 'G', 'N', 'P', 'C', '\0'};
+const uint32_t VERSION_CACHE = 1;
+const size_t TAILLE_ENTETE_CACHE = 48;
+
+class CachePaires
+{
+  private:
+    std::string chemin; // Path of the cache file
+
+    unsigned char* projection; // Mapped file
+
+    size_t tailleFichier; // Length of the file
+
+    size_t nbPaires; // Number of pairs: n(n-1)/2
+
+    uint32_t octetsCompte; // Bytes per count: 2 or 4
+
+    bool lecture; // True if the counts are read from an existing cache file
+
+    bool ecriture; // True if the counts are written in a new cache file
+
+    // Function to unmap the file
+    void fermer();
+
+  public:
+    // CachePaires Class constructor: open the cache file of the alignment in dossier, or create it if it doesn't exist
+    CachePaires(const std::string& dossier, int n, size_t longueur, uint64_t empreinte, uint32_t politique);
+
+    // Function to get the code of the gap policy (removal of the columns with a gap, threshold of gaps and X in %, negative: no threshold)
+    static uint32_t politiqueGaps(bool sansGaps, double seuil);
+
+    // CachePaires Class destructor: unmap the file (a cache file not finished is removed)
+    ~CachePaires();
+
+    // The mapped file is not shared between two objects
+    CachePaires(const CachePaires&) = delete;
+    CachePaires& operator=(const CachePaires&) = delete;
+
+    // Function to check if the counts are read from the cache file (no counting)
+    bool disponible() const { return lecture; };
+
+    // Function to check if the counts must be written in the cache file
+    bool aRemplir() const { return ecriture; };
+
+    // Function to stock the path of the cache file
+    const std::string& fichier() const { return chemin; };
+
+    // Function to read the counts of a pair
+    comptes lire(size_t paire) const;
+
+    // Function to write the counts of a pair
+    void stocker(size_t paire, const comptes& c);
+
+    // Function to write the counts [debut, fin) in the file and release them from memory
+    void liberer(size_t debut, size_t fin) const;
+
+    // Function to finish the cache file: it can be used by the next runs
+    void terminer();
+};
+#endif
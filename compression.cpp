@@ -0,0 +1,201 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Compression: Decompression of gzip and BGZF FASTA files (BGZF blocks are decompressed in parallel).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <atomic>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "compression.hpp"
+#include "parallele.hpp"
+
+using namespace std;
+
+// Function to read a little endian integer of 2 or 4 bytes
+static uint32_t lireEntier(const unsigned char* octets, int nbOctets)
+{
+    uint32_t valeur = 0;
+    for (int o = nbOctets - 1; o >= 0; o--)
+    {
+        valeur = (valeur << 8) | octets[o];
+    }
+    return valeur;
+}
+
+// Function to check if the file content is compressed with gzip (or BGZF)
+bool Compression::compresse(const char* donnees, size_t taille)
+{
+    return (taille >= 2) && ((unsigned char)donnees[0] == 0x1f) && ((unsigned char)donnees[1] == 0x8b);
+}
+
+// Function to find all blocks of a BGZF file (false if the file is not a BGZF file)
+bool Compression::blocsBGZF(const unsigned char* donnees, size_t taille, vector<blocBGZF>& blocs)
+{
+    size_t position = 0;
+    while (position < taille)
+    {
+        // Gzip header with the extra field (FLG.FEXTRA)
+        if ((taille - position < 18) || (donnees[position] != 0x1f) || (donnees[position + 1] != 0x8b)
+            || (donnees[position + 2] != 8) || !(donnees[position + 3] & 4))
+        {
+            return false;
+        }
+        size_t tailleExtra = lireEntier(donnees + position + 10, 2);
+        if (position + 12 + tailleExtra > taille)
+        {
+            return false;
+        }
+
+        // Subfield "BC": total length of the block - 1
+        size_t tailleBloc = 0;
+        size_t champ = position + 12;
+        while (champ + 4 <= position + 12 + tailleExtra)
+        {
+            size_t tailleChamp = lireEntier(donnees + champ + 2, 2);
+            if ((donnees[champ] == 'B') && (donnees[champ + 1] == 'C') && (tailleChamp == 2))
+            {
+                tailleBloc = lireEntier(donnees + champ + 4, 2) + 1;
+            }
+            champ += 4 + tailleChamp;
+        }
+        if ((tailleBloc == 0) || (position + tailleBloc > taille) || (tailleBloc < 12 + tailleExtra + 8))
+        {
+            return false;
+        }
+
+        blocBGZF bloc;
+        bloc.debut = position + 12 + tailleExtra;
+        bloc.tailleCompressee = tailleBloc - 12 - tailleExtra - 8;
+        bloc.crc = lireEntier(donnees + position + tailleBloc - 8, 4);
+        bloc.tailleDecompressee = lireEntier(donnees + position + tailleBloc - 4, 4);
+        blocs.push_back(bloc);
+        position += tailleBloc;
+    }
+    return true;
+}
+
+// Function to decompress a BGZF file: blocks are decompressed in parallel and given in order
+bool Compression::decompresserBGZF(const unsigned char* donnees, const vector<blocBGZF>& blocs, const function<void(const char*, size_t)>& alimenter)
+{
+    Parallele parallele(nbThreads);
+
+    // Blocks are decompressed by groups: memory is limited to a few blocks per thread
+    size_t tailleGroupe = (size_t)parallele.nombreThreads() * 8;
+    vector<string> decompresses(tailleGroupe);
+    atomic<bool> correct(true);
+
+    for (size_t premier = 0; premier < blocs.size(); premier += tailleGroupe)
+    {
+        size_t nbBlocs = min(tailleGroupe, blocs.size() - premier);
+        parallele.executer(nbBlocs, [&](size_t b)
+        {
+            const blocBGZF& bloc = blocs[premier + b];
+            string& sortie = decompresses[b];
+            sortie.resize(bloc.tailleDecompressee);
+
+            // Raw deflate data (no gzip header)
+            z_stream flux = {};
+            if (inflateInit2(&flux, -15) != Z_OK)
+            {
+                correct = false;
+                return;
+            }
+            flux.next_in = (Bytef*)(donnees + bloc.debut);
+            flux.avail_in = bloc.tailleCompressee;
+            flux.next_out = (Bytef*)sortie.data();
+            flux.avail_out = bloc.tailleDecompressee;
+            int resultat = inflate(&flux, Z_FINISH);
+            inflateEnd(&flux);
+
+            // The block must give exactly its length and its CRC32
+            if ((resultat != Z_STREAM_END) || (flux.total_out != bloc.tailleDecompressee)
+                || (crc32(0L, (const Bytef*)sortie.data(), sortie.size()) != bloc.crc))
+            {
+                correct = false;
+            }
+        });
+        if (!correct)
+        {
+            return false;
+        }
+        for (size_t b = 0; b < nbBlocs; b++)
+        {
+            alimenter(decompresses[b].data(), decompresses[b].size());
+        }
+    }
+    return true;
+}
+
+// Function to decompress a gzip file (one or several members) on one thread
+bool Compression::decompresserGzip(const unsigned char* donnees, size_t taille, const function<void(const char*, size_t)>& alimenter)
+{
+    // Decompressed parts of 256 KB
+    vector<char> sortie(1 << 18);
+
+    // 15 + 32: gzip or zlib header detected automatically
+    z_stream flux = {};
+    if (inflateInit2(&flux, 15 + 32) != Z_OK)
+    {
+        return false;
+    }
+    flux.next_in = (Bytef*)donnees;
+    flux.avail_in = taille;
+    int resultat = Z_OK;
+    while (true)
+    {
+        flux.next_out = (Bytef*)sortie.data();
+        flux.avail_out = sortie.size();
+        resultat = inflate(&flux, Z_NO_FLUSH);
+        if ((resultat != Z_OK) && (resultat != Z_STREAM_END))
+        {
+            break;
+        }
+        alimenter(sortie.data(), sortie.size() - flux.avail_out);
+        if (resultat == Z_STREAM_END)
+        {
+            // Next gzip member of a concatenated file
+            if (flux.avail_in == 0)
+            {
+                break;
+            }
+            inflateReset(&flux);
+        }
+    }
+    inflateEnd(&flux);
+    return resultat == Z_STREAM_END;
+}
+
+// Function to decompress a gzip or BGZF file content, decompressed parts are given in order to the alimenter function
+bool Compression::decompresser(const char* donnees, size_t taille, const function<void(const char*, size_t)>& alimenter)
+{
+    const unsigned char* octets = (const unsigned char*)donnees;
+    vector<blocBGZF> blocs;
+    if (blocsBGZF(octets, taille, blocs))
+    {
+        journal() << "BGZF file: " << blocs.size() << " blocks decompressed in parallel.\n";
+        return decompresserBGZF(octets, blocs, alimenter);
+    }
+    journal() << "Gzip file.\n";
+    return decompresserGzip(octets, taille, alimenter);
+}
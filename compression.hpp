@@ -0,0 +1,78 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Compression: Decompression of gzip and BGZF FASTA files (BGZF blocks are decompressed in parallel).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <stdint.h>
+
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+/*
+ Bloc BGZF: un membre gzip avec le champ "BC" qui donne la taille compressée du bloc.
+ Les blocs sont indépendants: ils peuvent être décompressés en parallèle
+*/
+struct blocBGZF
+{
+  size_t debut; // Position of the compressed data (deflate) in the file
+  size_t tailleCompressee; // Length of the compressed data
+  uint32_t crc; // CRC32 of the decompressed data
+  uint32_t tailleDecompressee; // Length of the decompressed data (64 KB maximum)
+};
+
+class Compression
+{
+  private:
+    int nbThreads; // Number of threads to decompress BGZF blocks
+
+    // Function to find all blocks of a BGZF file (false if the file is not a BGZF file)
+    bool blocsBGZF(const unsigned char* donnees, size_t taille, std::vector<blocBGZF>& blocs);
+
+    // Function to decompress a BGZF file: blocks are decompressed in parallel and given in order
+    bool decompresserBGZF(const unsigned char* donnees, const std::vector<blocBGZF>& blocs, const std::function<void(const char*, size_t)>& alimenter);
+
+    // Function to decompress a gzip file (one or several members) on one thread
+    bool decompresserGzip(const unsigned char* donnees, size_t taille, const std::function<void(const char*, size_t)>& alimenter);
+
+  public:
+    // Compression Class constructor
+    Compression(int threads = 1)
+    {
+      nbThreads = threads;
+      journal() << "Compression Class constructor.\n";
+    };
+
+    // Compression Class destructor
+    ~Compression()
+    {
+      journal() << "Compression Class destructor.\n";
+    };
+
+    // Function to check if the file content is compressed with gzip (or BGZF)
+    static bool compresse(const char* donnees, size_t taille);
+
+    // Function to decompress a gzip or BGZF file content, decompressed parts are given in order to the alimenter function
+    bool decompresser(const char* donnees, size_t taille, const std::function<void(const char*, size_t)>& alimenter);
+};
+#endif
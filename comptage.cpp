@@ -0,0 +1,200 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Comptage: Count substitutions and compared homologous sites between two aligned sequences (SIMD kernels chosen at runtime).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define COMPTAGE_X86
+#include <immintrin.h>
+#endif
+
+#include "comptage.hpp"
+#include "alignement.hpp"
+
+using namespace std;
+
+/*
+ Les noyaux sont instanciés pour chaque politique des sites:
+   tousCompares false: les sites avec un gap ou un acide aminé inconnu ne sont pas comparés (comptage des sites et des substitutions)
+   tousCompares true: l'alignement n'a ni gap ni "X", tous les sites sont comparés (comptage des substitutions seulement)
+*/
+
+// Scalar kernel: count substitutions and compared homologous sites site by site
+template <bool tousCompares>
+static comptes compterScalaire(const uint8_t* seq1, const uint8_t* seq2, size_t taille)
+{
+    comptes c = {0, 0};
+    for (size_t k = 0; k < taille; k++)
+    {
+        if constexpr (!tousCompares)
+        {
+            // Sites with gaps or unknown amino acids are not compared
+            if ((seq1[k] <= CODE_INCONNU) || (seq2[k] <= CODE_INCONNU))
+            {
+                continue;
+            }
+            c.sites++;
+        }
+        // Different compared sites are substitutions
+        if (seq1[k] != seq2[k])
+        {
+            c.substitutions++;
+        }
+    }
+    return c;
+}
+
+#ifdef COMPTAGE_X86
+
+/*
+ SIMD kernels: each instruction compares 16 (SSE4.2), 32 (AVX2) or 64 (AVX-512) sites.
+ For each block: mask of the sites where the smallest code of both sequences is a gap or an unknown amino acid,
+ mask of the equal sites, then popcount of the masks.
+ The end of the sequences (less than one block) uses the scalar kernel.
+*/
+
+// SSE4.2 kernel: 16 sites per instruction
+template <bool tousCompares>
+__attribute__((target("sse4.2,popcnt")))
+static comptes compterSSE42(const uint8_t* seq1, const uint8_t* seq2, size_t taille)
+{
+    const __m128i inconnu = _mm_set1_epi8(CODE_INCONNU);
+    comptes c = {0, 0};
+    size_t k = 0;
+    for (; k + 16 <= taille; k += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(seq1 + k));
+        __m128i b = _mm_loadu_si128((const __m128i*)(seq2 + k));
+        uint32_t masqueEgal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+        if constexpr (tousCompares)
+        {
+            c.substitutions += _mm_popcnt_u32(~masqueEgal & 0xFFFFu);
+            continue;
+        }
+        __m128i minimum = _mm_min_epu8(a, b);
+        // min(code, CODE_INCONNU) == code if code <= CODE_INCONNU (unsigned comparison)
+        __m128i nonCompare = _mm_cmpeq_epi8(_mm_min_epu8(minimum, inconnu), minimum);
+        uint32_t masqueValide = ~(uint32_t)_mm_movemask_epi8(nonCompare) & 0xFFFFu;
+        c.sites += _mm_popcnt_u32(masqueValide);
+        c.substitutions += _mm_popcnt_u32(masqueValide & ~masqueEgal);
+    }
+    comptes fin = compterScalaire<tousCompares>(seq1 + k, seq2 + k, taille - k);
+    c.sites += fin.sites;
+    c.substitutions += fin.substitutions;
+    return c;
+}
+
+// AVX2 kernel: 32 sites per instruction
+template <bool tousCompares>
+__attribute__((target("avx2,popcnt")))
+static comptes compterAVX2(const uint8_t* seq1, const uint8_t* seq2, size_t taille)
+{
+    const __m256i inconnu = _mm256_set1_epi8(CODE_INCONNU);
+    comptes c = {0, 0};
+    size_t k = 0;
+    for (; k + 32 <= taille; k += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(seq1 + k));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(seq2 + k));
+        uint32_t masqueEgal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        if constexpr (tousCompares)
+        {
+            c.substitutions += _mm_popcnt_u32(~masqueEgal);
+            continue;
+        }
+        __m256i minimum = _mm256_min_epu8(a, b);
+        __m256i nonCompare = _mm256_cmpeq_epi8(_mm256_min_epu8(minimum, inconnu), minimum);
+        uint32_t masqueValide = ~(uint32_t)_mm256_movemask_epi8(nonCompare);
+        c.sites += _mm_popcnt_u32(masqueValide);
+        c.substitutions += _mm_popcnt_u32(masqueValide & ~masqueEgal);
+    }
+    comptes fin = compterScalaire<tousCompares>(seq1 + k, seq2 + k, taille - k);
+    c.sites += fin.sites;
+    c.substitutions += fin.substitutions;
+    return c;
+}
+
+// AVX-512 kernel: 64 sites per instruction, comparisons give directly 64 bits masks
+template <bool tousCompares>
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static comptes compterAVX512(const uint8_t* seq1, const uint8_t* seq2, size_t taille)
+{
+    const __m512i inconnu = _mm512_set1_epi8(CODE_INCONNU);
+    comptes c = {0, 0};
+    size_t k = 0;
+    for (; k + 64 <= taille; k += 64)
+    {
+        __m512i a = _mm512_loadu_si512((const void*)(seq1 + k));
+        __m512i b = _mm512_loadu_si512((const void*)(seq2 + k));
+        uint64_t masqueDifferent = (uint64_t)_mm512_cmpneq_epi8_mask(a, b);
+        if constexpr (tousCompares)
+        {
+            c.substitutions += _mm_popcnt_u64(masqueDifferent);
+            continue;
+        }
+        uint64_t masqueValide = (uint64_t)_mm512_cmpgt_epu8_mask(_mm512_min_epu8(a, b), inconnu);
+        c.sites += _mm_popcnt_u64(masqueValide);
+        c.substitutions += _mm_popcnt_u64(masqueValide & masqueDifferent);
+    }
+    comptes fin = compterScalaire<tousCompares>(seq1 + k, seq2 + k, taille - k);
+    c.sites += fin.sites;
+    c.substitutions += fin.substitutions;
+    return c;
+}
+
+#endif
+
+// Comptage Class constructor: choose the best kernel for the processor ("auto") or the given instruction set
+Comptage::Comptage(string instructions)
+{
+    jeuInstructions = "scalar";
+    noyau = compterScalaire<false>;
+    noyauDifferences = compterScalaire<true>;
+#ifdef COMPTAGE_X86
+    __builtin_cpu_init();
+    bool automatique = (instructions == "auto");
+    if ((automatique || instructions == "avx512") && __builtin_cpu_supports("avx512bw"))
+    {
+        jeuInstructions = "avx512";
+        noyau = compterAVX512<false>;
+        noyauDifferences = compterAVX512<true>;
+    }else if ((automatique || instructions == "avx2") && __builtin_cpu_supports("avx2"))
+    {
+        jeuInstructions = "avx2";
+        noyau = compterAVX2<false>;
+        noyauDifferences = compterAVX2<true>;
+    }else if ((automatique || instructions == "sse4.2") && __builtin_cpu_supports("sse4.2"))
+    {
+        jeuInstructions = "sse4.2";
+        noyau = compterSSE42<false>;
+        noyauDifferences = compterSSE42<true>;
+    }
+#endif
+    journal() << "Comptage Class constructor.\n";
+}
+
+// Function to stock the name of the instruction set used by the kernel (scalar, sse4.2, avx2 or avx512)
+string Comptage::instructions()
+{
+    return jeuInstructions;
+}
@@ -0,0 +1,75 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Comptage: Count substitutions and compared homologous sites between two aligned sequences (SIMD kernels chosen at runtime).
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef COMPTAGE_HPP
+#define COMPTAGE_HPP
+
+/*
+ Structure pour contenir les comptages entre deux séquences alignées.
+ Un site est comparé si aucune des deux séquences n'a de gap "-" ou d'acide aminé inconnu "X" ou "x" (code inférieur ou égal à CODE_INCONNU)
+*/
+struct comptes
+{
+  uint64_t substitutions; // Number of substitutions
+  uint64_t sites; // Number of compared homologous sites
+};
+
+class Comptage
+{
+  private:
+    std::string jeuInstructions; // Name of the instruction set used by the kernel
+
+    comptes (*noyau)(const uint8_t* seq1, const uint8_t* seq2, size_t taille); // Counting kernel chosen at runtime
+
+    comptes (*noyauDifferences)(const uint8_t* seq1, const uint8_t* seq2, size_t taille); // Kernel of the alignments without gap and "X" (substitutions only)
+
+  public:
+    // Comptage Class constructor: choose the best kernel for the processor ("auto") or the given instruction set
+    Comptage(std::string instructions = "auto");
+
+    // Comptage Class destructor
+    ~Comptage()
+    {
+      journal() << "Comptage Class destructor.\n";
+    };
+
+    // Function to stock the name of the instruction set used by the kernel (scalar, sse4.2, avx2 or avx512)
+    std::string instructions();
+
+    // Function to count substitutions and compared homologous sites between two encoded sequences of length taille
+    comptes compterPaire(const uint8_t* seq1, const uint8_t* seq2, size_t taille) const
+    {
+      return noyau(seq1, seq2, taille);
+    };
+
+    // Function to count substitutions only, when all sites are compared (no gap and no unknown amino acid in both sequences)
+    comptes compterDifferences(const uint8_t* seq1, const uint8_t* seq2, size_t taille) const
+    {
+      return noyauDifferences(seq1, seq2, taille);
+    };
+};
+#endif
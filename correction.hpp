@@ -0,0 +1,231 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Corrections of the evolutionary distances methods (one policy per method, inlined in the pair loops) and class TableCorrection: memoization of the corrected distances, keyed by the number of substitutions and of compared sites.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <math.h>
+#include <stdint.h>
+
+#ifndef CORRECTION_HPP
+#define CORRECTION_HPP
+
+/*
+ Méthode de distances évolutives choisie avec l'option --methods (ex. "p", "pc:LG", "ei:WAG").
+ Les paramètres alpha et beta sont donnés par le modèle de substitution (méthodes "pc" et "ei")
+*/
+struct descripteurMethode
+{
+  std::string nom; // Method: "d", "p", "k", "jc", "pc" or "ei"
+  std::string modele; // Amino acids substitution model (empty for "d", "p", "k" and "jc")
+  double alpha; // Alpha parameter of the estimation models
+  double beta; // Beta parameter of the estimation models
+};
+
+/*
+ Politiques de correction: distance évolutive d'une paire à partir de p = s/sites.
+ Les boucles des paires sont instanciées pour chaque politique, la correction est appliquée dès que les comptes de la paire sont connus
+*/
+
+// Distance estimation: p (method "d")
+struct correctionDivergence
+{
+  static const bool identite = true;
+  double operator()(double p) const { return p; };
+};
+
+// Poisson model for amino acids: t = -ln(1-p) (method "p")
+struct correctionPoisson
+{
+  static const bool identite = false;
+  double operator()(double p) const { return -log(1.0-p); };
+};
+
+// Kimura estimation for PAM model: t = -ln(1-p-0.2*p²) (method "k")
+struct correctionKimura
+{
+  static const bool identite = false;
+  double operator()(double p) const { return -log(1.0-p-0.2*(p*p)); };
+};
+
+// Jukes-Cantor model for amino acids: t = -19/20*ln(1-20/19*p) (method "jc")
+struct correctionJukesCantor
+{
+  static const bool identite = false;
+  double operator()(double p) const { return -19.0/20.0*log(1.0-20.0/19.0*p); };
+};
+
+// Estimation models (Poisson Correction or Equal-Input): t = a*b*((1-p/b)^-1a - 1) (methods "pc" and "ei")
+struct correctionGu
+{
+  static const bool identite = false;
+  double alpha; // Alpha parameter of the substitution model
+  double beta; // Beta parameter of the substitution model (1 for Poisson Correction)
+  double operator()(double p) const { return alpha*beta*(pow(1-p/beta, -1/alpha)-1); };
+};
+
+// Function to call fonction with the correction policy of a method: one instance of fonction is compiled for each method
+template <class Fonction>
+void selonCorrection(const descripteurMethode& methode, Fonction&& fonction)
+{
+  if (methode.nom == "p")
+  {
+    fonction(correctionPoisson());
+  }else if (methode.nom == "k")
+  {
+    fonction(correctionKimura());
+  }else if (methode.nom == "jc")
+  {
+    fonction(correctionJukesCantor());
+  }else if ((methode.nom == "pc") || (methode.nom == "ei"))
+  {
+    fonction(correctionGu{methode.alpha, methode.beta});
+  }else{
+    // Method "d": distances estimation are kept
+    fonction(correctionDivergence());
+  }
+}
+
+/*
+ Function to invert a correction: largest proportion p in [0, 1] whose corrected distance is at most distanceMaximum (-1: none).
+ The corrections increase with p until they are not defined (NaN), so the proportions whose distance is at most distanceMaximum
+ are an interval [0, p] found by bisection
+*/
+template <class Correction>
+double proportionMaximum(const Correction& correction, double distanceMaximum)
+{
+  if (!(correction(0.0) <= distanceMaximum))
+  {
+    return -1.0;
+  }
+  if (correction(1.0) <= distanceMaximum)
+  {
+    return 1.0;
+  }
+  double bas = 0.0;
+  double haut = 1.0;
+  for (int etape = 0; etape < 64; etape++)
+  {
+    double milieu = 0.5 * (bas + haut);
+    if (correction(milieu) <= distanceMaximum)
+    {
+      bas = milieu;
+    }else{
+      haut = milieu;
+    }
+  }
+  return bas;
+}
+
+/*
+ Table des distances corrigées d'une méthode, indexée par (substitutions, sites comparés).
+ La distance ne dépend que de p = s/sites: pour un nombre de sites donné, la ligne des sites + 1 valeurs possibles est calculée en une fois
+ (boucle contiguë de log/pow) dès que ce nombre de sites est assez fréquent, puis chaque paire est lue dans la ligne.
+ Les valeurs sont celles de la correction appliquée à p: la table ne change pas les distances
+*/
+template <class Correction>
+class TableCorrection
+{
+  private:
+    Correction correction; // Correction policy of the method
+
+    size_t sitesMaximum; // Largest number of compared sites of a pair
+
+    std::unique_ptr<std::atomic<double*>[]> lignes; // Row of the corrected distances of each number of sites (nullptr: not calculated)
+
+    std::unique_ptr<std::atomic<uint32_t>[]> utilisations; // Number of pairs calculated without row for each number of sites
+
+    std::atomic<size_t> valeursStockees; // Number of distances stocked in the rows (bounded by VALEURS_MAXIMUM)
+
+    // Function to calculate the row of a number of sites: corrected distances of s/sites for s in [0, sites]
+    void calculerLigne(size_t sites)
+    {
+      // No more row when the table is full: the distances are calculated pair by pair
+      if (valeursStockees.fetch_add(sites + 1, std::memory_order_relaxed) + sites + 1 > VALEURS_MAXIMUM)
+      {
+        return;
+      }
+      double* ligne = new double[sites + 1];
+      for (size_t s = 0; s <= sites; s++)
+      {
+        ligne[s] = correction((double)s / (double)sites);
+      }
+      lignes[sites].store(ligne, std::memory_order_release);
+    };
+
+  public:
+    // Maximum number of stocked distances (32 MB)
+    static const size_t VALEURS_MAXIMUM = (size_t)1 << 22;
+
+    // TableCorrection Class constructor: empty table of a correction for pairs of at most sitesMax compared sites (no table for "d")
+    TableCorrection(const Correction& correctionMethode, size_t sitesMax) : correction(correctionMethode)
+    {
+      sitesMaximum = Correction::identite ? 0 : sitesMax;
+      lignes.reset(new std::atomic<double*>[sitesMaximum + 1]);
+      utilisations.reset(new std::atomic<uint32_t>[sitesMaximum + 1]);
+      for (size_t sites = 0; sites <= sitesMaximum; sites++)
+      {
+        lignes[sites].store(nullptr, std::memory_order_relaxed);
+        utilisations[sites].store(0, std::memory_order_relaxed);
+      }
+      valeursStockees.store(0, std::memory_order_relaxed);
+    };
+
+    // TableCorrection Class destructor: release the rows
+    ~TableCorrection()
+    {
+      for (size_t sites = 0; sites <= sitesMaximum; sites++)
+      {
+        delete[] lignes[sites].load(std::memory_order_relaxed);
+      }
+    };
+
+    // The rows are not shared between two objects
+    TableCorrection(const TableCorrection&) = delete;
+    TableCorrection& operator=(const TableCorrection&) = delete;
+
+    // Function to get the corrected distance of a pair with s substitutions on sites compared sites (can be called by several threads)
+    double valeur(uint64_t s, uint64_t sites)
+    {
+      if constexpr (!Correction::identite)
+      {
+        if (sites <= sitesMaximum)
+        {
+          double* ligne = lignes[sites].load(std::memory_order_acquire);
+          if (ligne != nullptr)
+          {
+            return ligne[s];
+          }
+          // The row is calculated when its number of sites is used by about sites/8 pairs: the row costs less than the pairs
+          uint32_t nombre = utilisations[sites].fetch_add(1, std::memory_order_relaxed) + 1;
+          if (nombre == (uint32_t)std::max<uint64_t>(16, sites / 8 + 1))
+          {
+            calculerLigne(sites);
+          }
+        }
+      }
+      return correction((double)s / (double)sites);
+    };
+};
+#endif
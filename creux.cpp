@@ -0,0 +1,134 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class FichierCreux: Sparse output file of the pairs of sequences whose distance is at most a threshold, in text or binary format.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+
+#include "creux.hpp"
+#include "ecriture.hpp"
+
+using namespace std;
+
+// FichierCreux Class constructor: create the file and write its header and the names of the sequences
+FichierCreux::FichierCreux(const string& chemin, const EncodedAlignment& alignement, const string& methode, const string& modele,
+    uint32_t precision, double distanceMaximum)
+{
+    binaire = (precision != 0);
+    octetsValeur = precision;
+    nbPaires = 0;
+    fichier.open(chemin, binaire ? ios::binary : ios::out);
+    if (!fichier.is_open())
+    {
+        return;
+    }
+    int n = alignement.nombreSequences();
+
+    if (!binaire)
+    {
+        // Number of sequences and first word of each header: the pairs give the numbers of the sequences in this list
+        string tampon = to_string(n) + "\n";
+        for (int i = 0; i < n; i++)
+        {
+            tampon += alignement.entete(i).substr(0, alignement.entete(i).find(" "));
+            tampon += '\n';
+        }
+        fichier.write(tampon.data(), tampon.size());
+        return;
+    }
+
+    // The pairs begin at a multiple of 8 bytes; the number of pairs is written by terminer
+    string noms = MatriceBinaire::tableNoms(alignement, TAILLE_ENTETE_CREUX);
+    unsigned char entete[TAILLE_ENTETE_CREUX] = {};
+    memcpy(entete, MAGIQUE_CREUX, 8);
+    ecrireLE(entete + 8, VERSION_CREUX, 4);
+    ecrireLE(entete + 12, precision, 4);
+    ecrireLE(entete + 16, n, 8);
+    ecrireLE(entete + 24, alignement.empreinte(), 8);
+    ecrireLE(entete + 32, TAILLE_ENTETE_CREUX, 8);
+    ecrireLE(entete + 40, TAILLE_ENTETE_CREUX + noms.size(), 8);
+    uint64_t bits;
+    memcpy(&bits, &distanceMaximum, 8);
+    ecrireLE(entete + 56, bits, 8);
+    memcpy(entete + 64, methode.data(), min(methode.size(), TAILLE_NOM_BINAIRE));
+    memcpy(entete + 80, modele.data(), min(modele.size(), TAILLE_NOM_BINAIRE));
+    fichier.write((const char*)entete, TAILLE_ENTETE_CREUX);
+    fichier.write(noms.data(), noms.size());
+}
+
+// Function to add the pairs (i, j, distance) of row i at the end of tampon (can be called by several threads)
+void FichierCreux::formater(int i, const vector<pair<int, double>>& paires, string& tampon) const
+{
+    for (const pair<int, double>& paire : paires)
+    {
+        if (!binaire)
+        {
+            tampon += to_string(i);
+            tampon += '\t';
+            tampon += to_string(paire.first);
+            tampon += '\t';
+            EcritureTexte::ajouterDistance(tampon, paire.second);
+            tampon += '\n';
+            continue;
+        }
+        unsigned char champs[16];
+        ecrireLE(champs, i, 4);
+        ecrireLE(champs + 4, paire.first, 4);
+        if (octetsValeur == 4)
+        {
+            float distance = paire.second;
+            uint32_t bits;
+            memcpy(&bits, &distance, 4);
+            ecrireLE(champs + 8, bits, 4);
+        }else{
+            uint64_t bits;
+            memcpy(&bits, &paire.second, 8);
+            ecrireLE(champs + 8, bits, 8);
+        }
+        tampon.append((const char*)champs, 8 + octetsValeur);
+    }
+}
+
+// Function to write a buffer of nbPairesTampon formatted pairs, in the order of the rows
+void FichierCreux::ecrire(const string& tampon, size_t nbPairesTampon)
+{
+    fichier.write(tampon.data(), tampon.size());
+    nbPaires += nbPairesTampon;
+}
+
+// Function to finish the file: number of pairs in the header of the binary format
+bool FichierCreux::terminer()
+{
+    if (binaire)
+    {
+        unsigned char nombre[8];
+        ecrireLE(nombre, nbPaires, 8);
+        fichier.seekp(48);
+        fichier.write((const char*)nombre, 8);
+    }
+    fichier.close();
+    return !fichier.fail();
+}
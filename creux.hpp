@@ -0,0 +1,100 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class FichierCreux: Sparse output file of the pairs of sequences whose distance is at most a threshold, in text or binary format.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdint.h>
+
+#include "alignement.hpp" // alignement.hpp inclusion to use the headers and the hash of the alignment
+#include "binaire.hpp" // binaire.hpp inclusion to write little endian integers and the names table
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef CREUX_HPP
+#define CREUX_HPP
+
+/*
+ Format du fichier creux binaire (little endian):
+   En-tête de 96 octets:
+     "ALIGNSP" + '\0'          8 octets
+     version                   uint32
+     précision                 uint32 (4: float32, 8: float64)
+     n                         uint64
+     empreinte de l'alignement uint64
+     position des noms         uint64
+     position des paires       uint64 (multiple de 8)
+     nombre de paires          uint64
+     distance maximale         float64
+     méthode                   16 octets (complétés par '\0')
+     modèle                    16 octets (complétés par '\0')
+   Table des noms: comme mat.bin (empreinte uint64, longueur uint32 et en-tête de chaque séquence)
+   Paires: i uint32, j uint32 (i < j, numéros à partir de 0) et distance float32 ou float64, dans l'ordre des lignes
+ Format texte: n, puis le premier mot de l'en-tête de chaque séquence (une ligne par séquence),
+ puis une ligne "i<TAB>j<TAB>distance" par paire (numéros à partir de 0, distance à 6 décimales)
+*/
+const char MAGIQUE_CREUX[8] = {'A', 'L', 'I', 'G', 'N', 'S', 'P', '\0'};
+const uint32_t VERSION_CREUX = 1;
+const size_t TAILLE_ENTETE_CREUX = 96;
+
+class FichierCreux
+{
+  private:
+    std::ofstream fichier; // Output file
+
+    bool binaire; // True for the binary format, false for the text format
+
+    uint32_t octetsValeur; // Precision of the binary format: 4 (float32) or 8 (float64) bytes per distance
+
+    size_t nbPaires; // Number of written pairs
+
+  public:
+    /*
+      FichierCreux Class constructor: create the file and write its header and the names of the sequences
+        precision: 4 (float32) or 8 (float64) bytes per distance of the binary format (0: text format)
+    */
+    FichierCreux(const std::string& chemin, const EncodedAlignment& alignement, const std::string& methode, const std::string& modele,
+      uint32_t precision, double distanceMaximum);
+
+    // FichierCreux Class destructor
+    ~FichierCreux()
+    {
+      journal() << "FichierCreux Class destructor.\n";
+    };
+
+    // Function to check if the file is open
+    bool ouvert() const { return fichier.is_open(); };
+
+    // Function to stock the number of written pairs
+    size_t nombrePaires() const { return nbPaires; };
+
+    // Function to add the pairs (i, j, distance) of row i at the end of tampon (can be called by several threads)
+    void formater(int i, const std::vector<std::pair<int, double>>& paires, std::string& tampon) const;
+
+    // Function to write a buffer of nbPairesTampon formatted pairs, in the order of the rows
+    void ecrire(const std::string& tampon, size_t nbPairesTampon);
+
+    // Function to finish the file: number of pairs in the header of the binary format
+    bool terminer();
+};
+#endif
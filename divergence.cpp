@@ -25,120 +25,326 @@
 #include <vector>
 #include <string.h>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <atomic>
 #include <math.h>
 #include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "divergence.hpp"
+#include "parallele.hpp"
+#include "comptage.hpp"
+#include "bitslice.hpp"
+#include "matrice.hpp"
+#include "ecriture.hpp"
 
 using namespace std;
 
-// Function to calculate distances estimation between two amino acids sequences and stock them in a vector
-vector<double> Divergence::vecteurDivergences(vector<fasta> vecFasta, int tailleVecteur)
+// Function to calculate evolutionary distances directly into the condensed matrice, by blocks of rows
+void Divergence::matriceDivergences(const EncodedAlignment& alignement, MatriceCondensee& matrice, int nbThreads, const string& moteur,
+    const descripteurMethode& methode, CachePaires* cache, const vector<int>* lignes)
 {
-    // Variable to count the number of substitutions between two sequences
-    double substitution = 0;
-
-    double match = 0;
-    double total = 0;
-    // Vector to stock temporarily distances estimation
-    vector<double> vecteurDivergenceObservee;
-
-    // Variable for distances estimation: p = n/l, n number of substitution and l number of compared homologous sites
-    double divergence = 0;
-
-    // Variable for indels, gaps in sequences
-    double indel = 0;
-
-    // Variable to compare homologous sites (length of comapred sequence - indels)
-    double site = 0;
-
-    // Iterator to calculate distances estimation
-    int j = 0;
-    int i = 1;
-
-    // Sequences comparison by "matrix" order (ex. between A/B A/C A/D A/E then B/C, B/D, B/E and D/E)
-    while (j <= tailleVecteur-1){
-        for (i = 1; i < tailleVecteur-j; i++){
-            string seq1 = vecFasta[i+j].s; // Iteration through sequences 1
-            string seq2 = vecFasta[j].s; // Iteration through sequences 2
-            int tailleSeq1 = seq1.length(); // Variable of sequence 2 length
-            for (int k = 0; k <= tailleSeq1; k++) 
+    // Number of sequences (compared rows of the alignment if lignes is given)
+    int tailleVecteur = lignes ? lignes->size() : alignement.nombreSequences();
+    double* distances = matrice.donnees();
+
+    // Counts of all pairs are in the cache file: the alignment is not compared
+    bool lectureCache = (cache != nullptr) && cache->disponible();
+    bool ecritureCache = (cache != nullptr) && cache->aRemplir();
+
+    // Counting engine: SIMD comparison of bytes or one hot encoding of the alignment (built once for all blocks)
+    unique_ptr<MoteurComptage> comptage;
+    if (lectureCache)
+    {
+        journal() << "Counts read from the cache.\n";
+    }else{
+        comptage.reset(new MoteurComptage(alignement, moteur));
+    }
+
+    size_t colonnes = lectureCache ? 0 : alignement.taille();
+    Mesures::globales().prevoirPaires((size_t)tailleVecteur * (tailleVecteur - 1) / 2);
+    auto mesurer = [&](size_t debut, size_t fin)
+    {
+        Mesures::globales().ajouterPaires(fin - debut, (fin - debut) * colonnes);
+    };
+
+    // Loop of the pairs instantiated for the correction of the method and the policy of the sites (all sites compared or not)
+    auto remplir = [&](auto correction, auto sites)
+    {
+        constexpr bool tousCompares = decltype(sites)::value;
+
+        // Corrected distances read in a table indexed by the counts (the same ratios are not corrected again)
+        TableCorrection<decltype(correction)> table(correction, alignement.colonnesPonderees());
+
+        auto calcul = [&](size_t paire, int j, int i)
+        {
+            comptes c;
+            if (lectureCache)
             {
-                // If compared sites are different not gaps or unknwon amino acids "X": they are substitution
-                if ((seq1[k] != seq2[k]) && (seq2[k] != seq1[k]) && ((seq1[k] != '-') && (seq2[k] != '-'))  && ((seq1[k] != 'X') && (seq2[k] != 'X')) && ((seq1[k] != 'x') && (seq2[k] != 'x'))) 
+                c = cache->lire(paire);
+            }else{
+                c = lignes ? comptage->template compterPaire<tousCompares>((*lignes)[i], (*lignes)[j])
+                  : comptage->template compterPaire<tousCompares>(i, j);
+                if (ecritureCache)
                 {
-                    substitution++;
+                    cache->stocker(paire, c);
                 }
-                // If compared sites are different gaps or unknwon amino acids "X": they are count in the indels variable
-                else if ((seq1[k] == '-') || (seq2[k] == '-') || (seq1[k] == 'X') || (seq2[k] == 'X') || (seq1[k] == 'x') || (seq2[k] == 'x'))  
-                {
-                    indel++;
-                }else{
-                // Else sites are the same and ignored
-                    continue;
-                }   
             }
-            // Number of compared homologous sites
-            site = tailleSeq1 - indel;
-            // Calculate distances estimation
-            divergence = substitution/site;
-            // If distances estimation are not between the same sequence, they are not stocked
-            vecteurDivergenceObservee.push_back(divergence);
-
-            // Reset variables
-            substitution = 0;
-            indel = 0;
-            divergence =0;
-            site =0;
-            match = 0;
+            // p = n/l, n number of substitution and l number of compared homologous sites, corrected while the counts are in registers
+            distances[paire] = table.valeur(c.substitutions, c.sites);
+        };
+
+        // Blocks of complete rows with about PAIRES_BLOC pairs: only one block of the matrice is written at the same time
+        const size_t PAIRES_BLOC = (size_t)1 << 23;
+        size_t debut = 0;
+        int ligne = 0;
+        while (ligne < tailleVecteur - 1)
+        {
+            size_t fin = debut;
+            do
+            {
+                fin += tailleVecteur - 1 - ligne;
+                ligne++;
+            } while ((ligne < tailleVecteur - 1) && (fin - debut < PAIRES_BLOC));
+
+            parcourirPaires(tailleVecteur, nbThreads, calcul, debut, fin, mesurer);
+
+            // Finished rows are written in the file and removed from the resident memory
+            matrice.liberer(debut, fin);
+            if (cache != nullptr)
+            {
+                cache->liberer(debut, fin);
+            }
+            debut = fin;
         }
-        j++;
+    };
+    selonCorrection(methode, [&](auto correction)
+    {
+        if (comptage && comptage->tousCompares())
+        {
+            remplir(correction, true_type());
+        }else{
+            remplir(correction, false_type());
+        }
+    });
+
+    // All counts are written: the cache file can be used by the next runs
+    if (ecritureCache)
+    {
+        cache->terminer();
     }
-   return vecteurDivergenceObservee; // Return distances estimation vector
 }
 
-// Function to stock the lentgh of distances estimation vector
-int Divergence::tailleDivergenceObservee(vector<double> vecteurDivergenceObservee)
+// Function to expand the matrice of the unique sequences to all the sequences of the alignment
+void Divergence::developperMatrice(const EncodedAlignment& alignement, const MatriceCondensee& uniques, const vector<int>& lignes,
+    const vector<int>& groupes, MatriceCondensee& matrice, int nbThreads, const descripteurMethode& methode)
 {
-    int tailleDivergenceObservee = vecteurDivergenceObservee.size();
-    return tailleDivergenceObservee; // Return the lentgh of distances estimation vector
+    // Number of sequences
+    int tailleVecteur = alignement.nombreSequences();
+    double* distances = matrice.donnees();
+
+    // Distance between two copies of a unique sequence: no substitution on the compared sites of the sequence, then the correction
+    vector<double> identiques(lignes.size());
+    selonCorrection(methode, [&](auto correction)
+    {
+        for (size_t u = 0; u < lignes.size(); u++)
+        {
+            identiques[u] = correction(0.0 / (double)alignement.sitesCompares(lignes[u]));
+        }
+    });
+
+    Parallele parallele(nbThreads);
+
+    // Blocks of complete rows with about PAIRES_BLOC pairs: only one block of the matrice is written at the same time
+    const size_t PAIRES_BLOC = (size_t)1 << 23;
+    size_t debut = 0;
+    int ligne = 0;
+    while (ligne < tailleVecteur - 1)
+    {
+        int premiere = ligne;
+        size_t fin = debut;
+        do
+        {
+            fin += tailleVecteur - 1 - ligne;
+            ligne++;
+        } while ((ligne < tailleVecteur - 1) && (fin - debut < PAIRES_BLOC));
+
+        parallele.executer(ligne - premiere, [&](size_t r)
+        {
+            int i = premiere + r;
+            int groupe = groupes[i];
+            double* rangee = distances + matrice.index(i, i + 1);
+            for (int j = i + 1; j < tailleVecteur; j++)
+            {
+                rangee[j - i - 1] = (groupes[j] == groupe) ? identiques[groupe] : uniques.valeur(groupe, groupes[j]);
+            }
+        });
+
+        // Finished rows are written in the file and removed from the resident memory
+        matrice.liberer(debut, fin);
+        debut = fin;
+    }
 }
 
-// Function to stock evolutinary distances in a matrice (2D array)
-double** Divergence::distance(vector<double> distances, int tailleVecteur)
+// Function to update the previous result with the sequences added to the alignment (incremental mode)
+void Divergence::completerMatrice(const EncodedAlignment& alignement, const MatricePrecedente& precedente, MatriceCondensee& matrice, int nbThreads,
+    const string& moteur, const descripteurMethode& methode)
 {
-    // Matrice size: lentgh of vector struct fasta - 1
-    int tailleMatrice = tailleVecteur - 1;
+    // Number of sequences
+    int tailleVecteur = alignement.nombreSequences();
+    double* distances = matrice.donnees();
+
+    // Index of each sequence in the previous result (-1: new sequence) and rank of the new sequences
+    vector<int> anciens = precedente.correspondances(alignement);
+    vector<int> nouvelles;
+    vector<int> rang(tailleVecteur, -1);
+    for (int i = 0; i < tailleVecteur; i++)
+    {
+        if (anciens[i] < 0)
+        {
+            rang[i] = nouvelles.size();
+            nouvelles.push_back(i);
+        }
+    }
+    journal() << tailleVecteur - nouvelles.size() << " sequences found in the previous result, " << nouvelles.size() << " new sequences.\n";
 
-    // Initialisation of the 2D array
-    double **distanceEvolutive = new double *[tailleMatrice];
+    Parallele parallele(nbThreads);
 
-    for(int i = 0; i < tailleMatrice; i++)
+    // Pairs of two sequences of the previous result: distances are copied
+    parallele.executer(tailleVecteur, [&](size_t i)
+    {
+        if (anciens[i] < 0)
+        {
+            return;
+        }
+        for (int j = i + 1; j < tailleVecteur; j++)
+        {
+            if (anciens[j] >= 0)
+            {
+                distances[matrice.index(i, j)] = precedente.valeur(anciens[i], anciens[j]);
+            }
+        }
+    });
+
+    /*
+    Pairs with a new sequence: one task per new sequence, with all the previous sequences and the new sequences before it,
+    so each pair is calculated once and the work is O(n.k) instead of O(n²)
+    */
+    MoteurComptage comptage(alignement, moteur);
+    size_t nbNouvelles = nouvelles.size();
+    Mesures::globales().prevoirPaires(nbNouvelles * (tailleVecteur - nbNouvelles) + nbNouvelles * (nbNouvelles - 1) / 2);
+    selonCorrection(methode, [&](auto correction)
+    {
+        TableCorrection<decltype(correction)> table(correction, alignement.colonnesPonderees());
+        parallele.executer(nouvelles.size(), [&](size_t t)
+        {
+            int i = nouvelles[t];
+            vector<int> autres;
+            vector<double> divergences;
+            for (int j = 0; j < tailleVecteur; j++)
+            {
+                if ((j == i) || ((anciens[j] < 0) && (rang[j] > (int)t)))
+                {
+                    continue;
+                }
+                // Same counts as the upper triangle: the comparison of two sequences is symmetric
+                comptes c = comptage.compterPaire(max(i, j), min(i, j));
+                autres.push_back(j);
+                divergences.push_back(table.valeur(c.substitutions, c.sites));
+            }
+            Mesures::globales().ajouterPaires(autres.size(), autres.size() * alignement.taille());
+            for (size_t k = 0; k < autres.size(); k++)
+            {
+                distances[matrice.index(min(i, autres[k]), max(i, autres[k]))] = divergences[k];
+            }
+        });
+    });
+}
+
+// Function to calculate the distance matrices of the bootstrap replicates in one pass over the pairs, by blocks of rows
+void Divergence::matricesBootstrap(const EncodedAlignment& alignement, const ReplicatsBootstrap& replicats, vector<MatriceCondensee>& matrices,
+    int nbThreads, const descripteurMethode& methode)
+{
+    // Number of sequences and of replicates
+    int tailleVecteur = alignement.nombreSequences();
+    int nbReplicats = replicats.nombre();
+    vector<double*> distances(nbReplicats);
+    for (int r = 0; r < nbReplicats; r++)
     {
-        distanceEvolutive[i] = new double[tailleMatrice]{}; // Initialisate matrice at 0
+        distances[r] = matrices[r].donnees();
     }
-    // If no memory can be allocated, program exit
-    if (distanceEvolutive == NULL)
+
+    if (nbReplicats == 0)
     {
-        cerr << "Error: impossible to allocate memory.\n";
-        exit(0);
+        return;
     }
-    // Variable to stop the iteration and get a triangular matrice
-    int passage = 0;
-    // Variable to iterate into evolutinary distances matrice
-    int vecteur = 0;
 
-    // Function to create (upper) evolutinary distances triangular matrice
-    for(int i = 0; i < tailleMatrice; i++)
+    size_t colonnes = alignement.taille();
+    Mesures::globales().prevoirPaires((size_t)tailleVecteur * (tailleVecteur - 1) / 2);
+
+    selonCorrection(methode, [&](auto correction)
     {
-        for (int j = 0+passage; j < tailleMatrice; j++)
+        // The weights of a replicate sum to the number of columns: largest number of compared sites of a pair
+        TableCorrection<decltype(correction)> table(correction, colonnes);
+
+        // Blocks of complete rows: the distances of a block are written in all the matrices (about 8M distances per block)
+        const size_t PAIRES_BLOC = max((size_t)1, ((size_t)1 << 23) / max(nbReplicats, 1));
+        // Tasks of a block: pieces of at most PAIRES_TACHE pairs of a row, counted together
+        const int PAIRES_TACHE = 64;
+        Parallele parallele(nbThreads);
+        size_t debut = 0;
+        int ligne = 0;
+        while (ligne < tailleVecteur - 1)
         {
-            // Copy evolutinary distances vector values in upper matrice
-            distanceEvolutive[i][j] = distances[vecteur++];
+            size_t fin = debut;
+            vector<pair<int, int>> taches; // Row and first sequence of each task
+            do
+            {
+                for (int premier = ligne + 1; premier < tailleVecteur; premier += PAIRES_TACHE)
+                {
+                    taches.push_back(make_pair(ligne, premier));
+                }
+                fin += tailleVecteur - 1 - ligne;
+                ligne++;
+            } while ((ligne < tailleVecteur - 1) && (fin - debut < PAIRES_BLOC));
+
+            parallele.executer(taches.size(), [&](size_t tache)
+            {
+                // Counts of the pairs of the task in all the replicates, then the corrected distance of each replicate
+                thread_local vector<uint32_t> substitutions;
+                thread_local vector<uint32_t> sites;
+                substitutions.resize(PAIRES_TACHE * replicats.pasReplicats());
+                sites.resize(PAIRES_TACHE * replicats.pasReplicats());
+                int j = taches[tache].first;
+                int premier = taches[tache].second;
+                int dernier = min(tailleVecteur, premier + PAIRES_TACHE);
+                replicats.compterPaires(j, premier, dernier, substitutions.data(), sites.data());
+                // The distances of the task are contiguous in each matrice
+                size_t paire = matrices[0].index(j, premier);
+                size_t pas = replicats.pasReplicats();
+                for (int r = 0; r < nbReplicats; r++)
+                {
+                    double* distancesReplicat = distances[r] + paire;
+                    for (int p = 0; p < dernier - premier; p++)
+                    {
+                        distancesReplicat[p] = table.valeur(substitutions[p * pas + r], sites[p * pas + r]);
+                    }
+                }
+                Mesures::globales().ajouterPaires(dernier - premier, (dernier - premier) * colonnes);
+            });
+
+            // Finished rows are written in the files and removed from the resident memory
+            for (int r = 0; r < nbReplicats; r++)
+            {
+                matrices[r].liberer(debut, fin);
+            }
+            debut = fin;
         }
-        passage++;
-    }  
-   return distanceEvolutive; // Return evolutinary distances matrice
+    });
 }
 
 /*
@@ -148,9 +354,13 @@ double** Divergence::distance(vector<double> distances, int tailleVecteur)
         Header sequences
         Compared sequences and evolutinary distances
 */
-ofstream Divergence::fichierDist(double** distanceEvolutive, vector<double> vecteurDistances, vector<fasta> vecFasta, int tailleVecteur)
+ofstream Divergence::fichierDist(const MatriceCondensee& matrice, const EncodedAlignment& alignement, int nbThreads,
+    const string& nomFichier)
 {
-    ofstream fichier("seqs.dist");
+    // Number of amino acids sequences
+    int tailleVecteur = matrice.nombreSequences();
+
+    ofstream fichier(nomFichier);
     if (fichier.is_open())
     {
         fichier << "#distances order: d(1,2),...,d(1,n) <new line> d(2,3),...,d(2,n) <new line>...\n"
@@ -158,59 +368,74 @@ ofstream Divergence::fichierDist(double** distanceEvolutive, vector<double> vect
         << tailleVecteur;
         fichier << "\n";
 
-        // Triangular matrice of evolutinary distances
-        for(int i = 0; i < tailleVecteur - 1; i++)
+        // Stock the first word of the headers separate by a blank space (" ")
+        vector<string> enteteSeule;
+        for (int m = 0; m < tailleVecteur; m++)
+        {
+            enteteSeule.push_back(alignement.entete(m).substr(0, alignement.entete(m).find(" ")));
+        }
+
+        // Blocks of rows of the upper triangle with about 64K distances
+        vector<int> debutsBlocs(1, 0);
+        size_t distancesBloc = 0;
+        for (int i = 0; i < tailleVecteur - 1; i++)
         {
-            for (int j = 0; j < tailleVecteur - 1; j++)
+            distancesBloc += tailleVecteur - 1 - i;
+            if ((distancesBloc >= ((size_t)1 << 16)) || (i == tailleVecteur - 2))
             {
-                if (i <= j){
-                    cout << fixed;
-                    // Decimal value to 6
-                    cout << setprecision(6) << showpoint;
-                    fichier << distanceEvolutive[i][j] << " ";
-                }
+                debutsBlocs.push_back(i + 1);
+                distancesBloc = 0;
             }
-            fichier << "\n";
         }
+        size_t nbBlocs = debutsBlocs.size() - 1;
+        EcritureTexte ecriture(nbThreads);
 
-       // Vector to stock pairwise headers
-       vector<string> paires;
-
-        // Vector to stock only headers
-        vector<string> enteteSeule;
-
-        // Vector to stock pairwise headers (calculate evolutinary distances between two sequences)
-        int m = 0;
-        int n = 1;
-        while (m <= tailleVecteur-1){
-            // Stock the first word of the header separate by a blank space (" ")
-            int partie2 = vecFasta[m].e.find(" ");
-            string entete2 = vecFasta[m].e.substr(0, partie2);
-            enteteSeule.push_back(entete2+ "");
-            // Stock only header
-            fichier << enteteSeule[m] << " "; 
-
-            // Creation of pairwise headers in function of the order of compared sequences
-            for (n = 1; n < tailleVecteur-m; n++){
-                int partie1 = vecFasta[n+m].e.find(" ");
-                string entete1 = vecFasta[n+m].e.substr(0, partie1);
-                paires.push_back(entete2+","+entete1+": ");
+        // Triangular matrice of evolutinary distances, with 6 decimals
+        ecriture.ecrireBlocs(fichier, nbBlocs, [&](size_t bloc, string& tampon)
+        {
+            for (int i = debutsBlocs[bloc]; i < debutsBlocs[bloc + 1]; i++)
+            {
+                for (int j = i + 1; j < tailleVecteur; j++)
+                {
+                    EcritureTexte::ajouterDistance(tampon, matrice.valeur(i, j));
+                    tampon += ' ';
+                }
+                tampon += '\n';
             }
-            m++;
+            // The matrice is read once in order: written rows are released (matrice stocked in a file)
+            matrice.liberer(matrice.index(debutsBlocs[bloc], debutsBlocs[bloc] + 1), matrice.index(debutsBlocs[bloc + 1] - 1, tailleVecteur - 1) + 1);
+        });
+
+        // Stock only header
+        for (int m = 0; m < tailleVecteur; m++)
+        {
+            fichier << enteteSeule[m] << " ";
         }
 
         fichier << "\n";
         fichier << "\n";
         fichier << "#pairwise distances\n";
 
-        // Match between comapared sequences and evolutinary distances
-        for (int i = 0; i < paires.size(); ++i) 
+        // Match between comapared sequences and evolutinary distances, in the order of compared sequences
+        ecriture.ecrireBlocs(fichier, nbBlocs, [&](size_t bloc, string& tampon)
         {
-            fichier << paires[i] << vecteurDistances[i] << "\n";    
-        }
+            for (int i = debutsBlocs[bloc]; i < debutsBlocs[bloc + 1]; i++)
+            {
+                for (int j = i + 1; j < tailleVecteur; j++)
+                {
+                    tampon += enteteSeule[i];
+                    tampon += ',';
+                    tampon += enteteSeule[j];
+                    tampon += ": ";
+                    EcritureTexte::ajouterDistance(tampon, matrice.valeur(i, j));
+                    tampon += '\n';
+                }
+            }
+            matrice.liberer(matrice.index(debutsBlocs[bloc], debutsBlocs[bloc] + 1), matrice.index(debutsBlocs[bloc + 1] - 1, tailleVecteur - 1) + 1);
+        });
         fichier.close();
     }else{
-        cout << "The file can't be write\n";
+        cerr << "The file can't be write\n";
     }
     // Close file
     fichier.close();
@@ -222,68 +447,330 @@ ofstream Divergence::fichierDist(double** distanceEvolutive, vector<double> vect
     Function to create mat.dist (3rd argument option "-m" or "--matrice"): 
         Triangular matrice in PHYLIP format
 */
-ofstream Divergence::fichierMat (double** distanceEvolutive, vector<double> vecteurDistances, vector<fasta> vecFasta, int tailleVecteur)
+ofstream Divergence::fichierMat(const MatriceCondensee& matrice, const EncodedAlignment& alignement, int nbThreads,
+    const string& nomFichier, bool ajout)
 {
-    ofstream fichier("mat.dist");
+    // Number of amino acids sequences
+    int tailleVecteur = matrice.nombreSequences();
+
+    ofstream fichier(nomFichier, ajout ? ios::app : ios::out);
     if (fichier.is_open())
     {
         // Number of amino acids sequences
         fichier << tailleVecteur << "\n";
 
-        // New triangular matrice (upper)
-        double temporaire[tailleVecteur][tailleVecteur]{};
-
-        // Variable to stop the iteration and get new triangular matrice
-        int vecteur = 0;
+        // Stock the first word of the header separate by a blank space (" ")
+        vector<string> enteteSeule;
+        for (int m = 0; m < tailleVecteur; m++)
+        {
+            enteteSeule.push_back(alignement.entete(m).substr(0, alignement.entete(m).find(" ")));
+        }
 
-        // Variable to iterate into evolutinary distances vector
-        int passage = 0;
+        /*
+        Matrice stocked in a file: the bottom of the rows (columns of the upper triangle) is written in a temporary file
+        in one forward pass over the triangle, so the rows are then read sequentially in both files
+        */
+        string nomColonnes = nomFichier + ".colonnes.tmp";
+        int colonnes = -1;
+        if (matrice.disque())
+        {
+            if (matrice.ecrireColonnes(nomColonnes))
+            {
+                colonnes = open(nomColonnes.c_str(), O_RDONLY);
+            }
+            if (colonnes < 0)
+            {
+                cerr << "Error: the temporary file " << nomColonnes << " can't be written, the columns are read in the matrice file.\n";
+                unlink(nomColonnes.c_str());
+            }
+        }
 
-        for(int i = 0; i < tailleVecteur; i++)
+        /*
+        Creation of the matrice in PHYLIP format: the bottom of the matrice is read in the upper triangle (or in the file of the columns).
+        Rows are rebuilt by tiles of about 32 MB, so the memory is bounded even if the matrice is stocked in a file,
+        then the rows of the tile are formatted by blocks of about 64K distances in parallel
+        */
+        int lignesTuile = max(1, (int)min((size_t)tailleVecteur, ((size_t)1 << 22) / max(tailleVecteur, 1)));
+        int lignesBloc = max(1, (int)min((size_t)lignesTuile, ((size_t)1 << 16) / max(tailleVecteur, 1)));
+        vector<double> tuile((size_t)lignesTuile * tailleVecteur);
+        EcritureTexte ecriture(nbThreads);
+        for (int premiere = 0; premiere < tailleVecteur; premiere += lignesTuile)
         {
-            for (int k = 0+passage; k < tailleVecteur; k++)
+            int derniere = min(tailleVecteur, premiere + lignesTuile);
+            if (!matrice.lireLignes(premiere, derniere, tuile.data(), colonnes))
             {
-                if (i < k)
+                cerr << "Error: the temporary file " << nomColonnes << " can't be read.\n";
+                break;
+            }
+            size_t nbBlocs = (derniere - premiere + lignesBloc - 1) / lignesBloc;
+            ecriture.ecrireBlocs(fichier, nbBlocs, [&](size_t bloc, string& tampon)
+            {
+                int debut = premiere + bloc * lignesBloc;
+                int fin = min(derniere, debut + lignesBloc);
+                for (int i = debut; i < fin; i++)
                 {
-                    // Copy values of the evolutinary distances vector into upper matrice
-                    temporaire[i][k] = vecteurDistances[vecteur++];
+                    // Stock only header
+                    tampon += enteteSeule[i];
+                    tampon += ' ';
+
+                    const double* ligne = tuile.data() + (size_t)(i - premiere) * tailleVecteur;
+                    for (int k = 0; k < tailleVecteur; k++)
+                    {
+                        // Matice in PHYLIP format with diagonal equal to 0, 6 decimals
+                        EcritureTexte::ajouterDistance(tampon, ligne[k]);
+                        tampon += '\t';
+                    }
+                    tampon += '\n';
                 }
+            });
+            // Pages read for the rows of the tile are released (matrice stocked in a file)
+            matrice.liberer(matrice.index(premiere, premiere + 1), matrice.index(derniere, derniere + 1));
+            if (colonnes >= 0)
+            {
+                posix_fadvise(colonnes, ((off_t)premiere * (premiere - 1) / 2) * sizeof(double),
+                    ((off_t)derniere * (derniere - 1) / 2 - (off_t)premiere * (premiere - 1) / 2) * sizeof(double), POSIX_FADV_DONTNEED);
             }
-            passage++;
         }
+        if (colonnes >= 0)
+        {
+            close(colonnes);
+            unlink(nomColonnes.c_str());
+        }
+        fichier << "\n";
+        fichier.close();
+    }else{
+        cerr << "The file can't be write\n";
+    }
+    // Close file
+    fichier.close();
+    return fichier; // Return mat.dist file
+}
+
+/*
+    Function to create mat.dist while distances are calculated (3rd argument option "-m" with "-s" or "--stream"):
+        Rows of the PHYLIP matrice are calculated, formatted and written by windows of rows
+*/
+ofstream Divergence::fichierMatFlux(const EncodedAlignment& alignement, int nbThreads, const string& moteur,
+    const descripteurMethode& methode, const string& nomFichier)
+{
+    // Number of amino acids sequences
+    int tailleVecteur = alignement.nombreSequences();
+
+    ofstream fichier(nomFichier);
+    if (fichier.is_open())
+    {
+        // Number of amino acids sequences
+        fichier << tailleVecteur << "\n";
 
-        // Creation of the matrice in PHYLIP format
-        for(int i = 0; i < tailleVecteur; i++)
+        // Stock the first word of the header separate by a blank space (" ")
+        vector<string> enteteSeule;
+        for (int m = 0; m < tailleVecteur; m++)
         {
-            // Stock headers
-            if ( i <= tailleVecteur -1){
-                // Stock the first word of the header separate by a blank space (" ")
-                int entete = vecFasta[i].e.find(" ");
-                string subEntete = vecFasta[i].e.substr(0, entete );
-                // Stock only header
-                fichier << subEntete << " ";
-            }
+            enteteSeule.push_back(alignement.entete(m).substr(0, alignement.entete(m).find(" ")));
+        }
 
-            for (int k = 0; k < tailleVecteur; k++)
+        // Counting engine: SIMD comparison of bytes or one hot encoding of the alignment
+        MoteurComptage comptage(alignement, moteur);
+
+        /*
+        A row i is final only when d(i,k) is known for all k: d(k,i), k < i, is calculated again for the row i
+        instead of keeping the previous rows, so the memory is bounded by the windows (about 4M distances each)
+        */
+        int lignesFenetre = max(1, (int)min((size_t)tailleVecteur, ((size_t)1 << 22) / max(tailleVecteur, 1)));
+        vector<string> fenetres[2] = {vector<string>(lignesFenetre), vector<string>(lignesFenetre)};
+        Parallele parallele(nbThreads);
+        thread ecrivain;
+        int numeroFenetre = 0;
+        // Each pair is calculated twice (once for each of its rows) but counted once, in the row of its first sequence
+        Mesures::globales().prevoirPaires((size_t)tailleVecteur * (tailleVecteur - 1) / 2);
+
+        selonCorrection(methode, [&](auto correction)
+        {
+            TableCorrection<decltype(correction)> table(correction, alignement.colonnesPonderees());
+            for (int premiere = 0; premiere < tailleVecteur; premiere += lignesFenetre)
             {
-                if (k >= i)
+                int derniere = min(tailleVecteur, premiere + lignesFenetre);
+                vector<string>* lignes = &fenetres[numeroFenetre];
+
+                // Rows of the window are calculated and formatted in parallel
+                parallele.executer(derniere - premiere, [&](size_t ligne)
                 {
-                    // Copy values of the upper triangular matrice to the bottom
-                    temporaire[k][i] =  temporaire[i][k];
+                    int i = premiere + ligne;
+                    vector<double> distances(tailleVecteur);
+                    for (int k = 0; k < tailleVecteur; k++)
+                    {
+                        if (k == i)
+                        {
+                            continue;
+                        }
+                        // Same counts as the upper triangle: the comparison of two sequences is symmetric
+                        comptes c = comptage.compterPaire(i, k);
+                        distances[k] = table.valeur(c.substitutions, c.sites);
+                    }
+                    Mesures::globales().ajouterPaires(tailleVecteur - 1 - i, (size_t)(tailleVecteur - 1 - i) * alignement.taille());
+                    // Matice in PHYLIP format with diagonal equal to 0
+                    distances[i] = 0.0;
+
+                    string& tampon = (*lignes)[ligne];
+                    tampon.clear();
+                    tampon += enteteSeule[i];
+                    tampon += ' ';
+                    for (int k = 0; k < tailleVecteur; k++)
+                    {
+                        EcritureTexte::ajouterDistance(tampon, distances[k]);
+                        tampon += '\t';
+                    }
+                    tampon += '\n';
+                });
+
+                // The previous window must be written before its buffers are used again
+                if (ecrivain.joinable())
+                {
+                    ecrivain.join();
                 }
-                fichier << fixed;
-                fichier << setprecision(6) << showpoint;
-                // Matice in PHYLIP format with diagonal equal to 0
-               fichier << temporaire[i][k] << "\t";
+                int nbLignes = derniere - premiere;
+                ecrivain = thread([&fichier, lignes, nbLignes]()
+                {
+                    for (int ligne = 0; ligne < nbLignes; ligne++)
+                    {
+                        fichier.write((*lignes)[ligne].data(), (*lignes)[ligne].size());
+                    }
+                    fichier.flush();
+                });
+                numeroFenetre = 1 - numeroFenetre;
             }
-            fichier << "\n";
+        });
+        if (ecrivain.joinable())
+        {
+            ecrivain.join();
         }
         fichier << "\n";
         fichier.close();
     }else{
-        cout << "The file can't be write\n";
+        cerr << "The file can't be write\n";
     }
     // Close file
     fichier.close();
     return fichier; // Return mat.dist file
 }
+
+// Function to write the pairs whose distance is at most distanceMaximum in a sparse file, with the counting of a pair stopped early
+size_t Divergence::fichierCreux(const EncodedAlignment& alignement, int nbThreads, const string& moteur, const descripteurMethode& methode,
+    double distanceMaximum, FichierCreux& fichier)
+{
+    // Number of amino acids sequences
+    int tailleVecteur = alignement.nombreSequences();
+
+    // Counting engine: SIMD comparison of bytes or one hot encoding of the alignment
+    MoteurComptage comptage(alignement, moteur);
+
+    // Compared sites of each sequence: the compared sites of a pair are at most those of its two sequences
+    vector<uint64_t> sitesSequences(tailleVecteur);
+    Parallele parallele(nbThreads);
+    parallele.executer(tailleVecteur, [&](size_t i)
+    {
+        sitesSequences[i] = alignement.sitesCompares(i);
+    });
+
+    // Windows of rows with about 4M pairs: the formatted rows of a window are written in order before the next window
+    size_t pairesFenetre = (size_t)1 << 22;
+    vector<string> tampons(tailleVecteur);
+    vector<size_t> pairesLignes(tailleVecteur);
+    atomic<size_t> interrompues(0);
+    Mesures::globales().prevoirPaires((size_t)tailleVecteur * (tailleVecteur - 1) / 2);
+
+    // Loop of the pairs instantiated for the correction of the method and the policy of the sites (all sites compared or not)
+    auto ecrire = [&](auto correction, auto sites)
+    {
+        constexpr bool tousCompares = decltype(sites)::value;
+        TableCorrection<decltype(correction)> table(correction, alignement.colonnesPonderees());
+
+        /*
+        Largest proportion of substitutions of a written pair: a pair with s substitutions on at most l compared sites
+        has a distance above distanceMaximum if s > proportion * l (with a margin for the rounding of the correction)
+        */
+        double proportion = proportionMaximum(correction, distanceMaximum);
+        if (proportion < 0.0)
+        {
+            journal() << "No distance can be at most " << distanceMaximum << " with this method.\n";
+            return;
+        }
+        journal() << "Largest proportion of substitutions of a written pair: " << proportion << ".\n";
+
+        int premiere = 0;
+        while (premiere < tailleVecteur - 1)
+        {
+            int derniere = premiere;
+            size_t paires = 0;
+            do
+            {
+                paires += tailleVecteur - 1 - derniere;
+                derniere++;
+            } while ((derniere < tailleVecteur - 1) && (paires < pairesFenetre));
+
+            // Rows of the window are calculated and formatted in parallel (decreasing number of pairs: alternate distribution)
+            parallele.executer(derniere - premiere, [&](size_t ligne)
+            {
+                int i = premiere + ligne;
+                vector<pair<int, double>> retenues;
+                uint64_t sitesLus = 0;
+                size_t stoppees = 0;
+                for (int j = i + 1; j < tailleVecteur; j++)
+                {
+                    uint64_t sitesMaximum = min(sitesSequences[i], sitesSequences[j]);
+                    uint64_t limite = (proportion >= 1.0) ? UINT64_MAX : (uint64_t)floor(proportion * (1.0 + 1e-9) * (double)sitesMaximum);
+                    comptes c;
+                    if (!comptage.template compterPaireBornee<tousCompares>(i, j, limite, c))
+                    {
+                        stoppees++;
+                        sitesLus += c.sites;
+                        continue;
+                    }
+                    sitesLus += c.sites;
+                    double distance = table.valeur(c.substitutions, c.sites);
+                    if (distance <= distanceMaximum)
+                    {
+                        retenues.push_back(make_pair(j, distance));
+                    }
+                }
+                tampons[i].clear();
+                fichier.formater(i, retenues, tampons[i]);
+                pairesLignes[i] = retenues.size();
+                interrompues.fetch_add(stoppees, memory_order_relaxed);
+                Mesures::globales().ajouterPaires(tailleVecteur - 1 - i, sitesLus);
+            }, true);
+
+            for (int i = premiere; i < derniere; i++)
+            {
+                fichier.ecrire(tampons[i], pairesLignes[i]);
+                string().swap(tampons[i]);
+            }
+            premiere = derniere;
+        }
+    };
+    selonCorrection(methode, [&](auto correction)
+    {
+        if (comptage.tousCompares())
+        {
+            ecrire(correction, true_type());
+        }else{
+            ecrire(correction, false_type());
+        }
+    });
+    return interrompues.load();
+}
+
+/*
+    Function to create mat.bin (3rd argument option "-b" or "--binary"):
+        Versioned header, names table and condensed matrice in little endian float32 or float64
+*/
+bool Divergence::fichierBinaire(const MatriceCondensee& matrice, const EncodedAlignment& alignement, const string& methode,
+    const string& modele, uint32_t precision, const string& nomFichier)
+{
+    if (!MatriceBinaire::ecrire(nomFichier, matrice, alignement, methode, modele, precision))
+    {
+        cerr << "The file can't be write\n";
+        return false;
+    }
+    return true;
+}
@@ -23,8 +23,22 @@
 #include <fstream>
 #include <vector>
 #include <string.h>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
 
 #include "fasta.hpp" // fasta.hpp inclusion to use it's functions (inheritance)
+#include "alignement.hpp" // alignement.hpp inclusion to use encoded sequences
+#include "matrice.hpp" // matrice.hpp inclusion to use condensed triangular matrice
+#include "binaire.hpp" // binaire.hpp inclusion to write the binary distance matrice
+#include "cache.hpp" // cache.hpp inclusion to read and write the pair counts cache
+#include "incremental.hpp" // incremental.hpp inclusion to read the previous result
+#include "mesures.hpp" // mesures.hpp inclusion to count the calculated pairs
+#include "parallele.hpp" // parallele.hpp inclusion to calculate the pairs on several threads
+#include "correction.hpp" // correction.hpp inclusion to use the correction policies of the methods and their table
+#include "bootstrap.hpp" // bootstrap.hpp inclusion to count the pairs of the bootstrap replicates
+#include "creux.hpp" // creux.hpp inclusion to write the sparse output file
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
 
 #ifndef DIVERGENCE_HPP
 #define DIVERGENCE_HPP
@@ -36,38 +50,157 @@ public:
   // Divergence Class constructor
   Divergence()
   {
-    std::cout << "Divergence Class constructor.\n";
+    journal() << "Divergence Class constructor.\n";
   };
 
   // Divergence Class destructor
   ~Divergence()
   {
-    std::cout << "Divergence Class destructor.\n";
+    journal() << "Divergence Class destructor.\n";
   };
 
-  // Function to calculate distances estimation between two sequences and stock them into a vector
-  std::vector<double> vecteurDivergences(std::vector<fasta> vecFasta, int tailleVecteur);
+  /*
+    Function to run a calculation on the compared sequences (j, i), j < i, in "matrix" order on nbThreads threads:
+      Only pairs [debutPaires, finPaires) of the triangle are calculated (all pairs by default)
+      finBloc is called by the thread on each calculated block of contiguous pairs [debut, fin)
+      The calculation is a template parameter: it is inlined in the loop of the pairs (no call through a function pointer for each pair)
+  */
+  template <class Calcul>
+  void parcourirPaires(int tailleVecteur, int nbThreads, const Calcul& calcul,
+    size_t debutPaires = 0, size_t finPaires = SIZE_MAX, const std::function<void(size_t debut, size_t fin)>& finBloc = nullptr)
+  {
+    // Number of compared sequences: n(n-1)/2
+    size_t nbPaires = (size_t)tailleVecteur * (tailleVecteur - 1) / 2;
+    finPaires = std::min(finPaires, nbPaires);
+    if (debutPaires >= finPaires)
+    {
+      return;
+    }
+    size_t nbPairesCalculees = finPaires - debutPaires;
+
+    // Threads to calculate distances estimation
+    Parallele parallele(nbThreads);
+
+    /*
+    The pairs are split in blocks with the same number of pairs.
+    There are more blocks than threads so threads which finish first can steal the remaining blocks
+    */
+    size_t nbBlocs = std::min(nbPairesCalculees, (size_t)parallele.nombreThreads() * 16);
+
+    // Sequences comparison by "matrix" order (ex. between A/B A/C A/D A/E then B/C, B/D, B/E and D/E)
+    parallele.executer(nbBlocs, [&](size_t bloc)
+    {
+      size_t debut = debutPaires + nbPairesCalculees * bloc / nbBlocs;
+      size_t fin = debutPaires + nbPairesCalculees * (bloc + 1) / nbBlocs;
+
+      // Find the first compared sequences of the block: row j of the triangle has n-1-j pairs
+      size_t j = 0;
+      size_t premier = 0;
+      while (premier + (tailleVecteur - 1 - j) <= debut)
+      {
+        premier += tailleVecteur - 1 - j;
+        j++;
+      }
+      size_t i = j + 1 + (debut - premier);
+
+      for (size_t paire = debut; paire < fin; paire++)
+      {
+        calcul(paire, j, i);
+        // Next pair: next sequence of the row, or first sequence of the next row
+        i++;
+        if (i == (size_t)tailleVecteur)
+        {
+          j++;
+          i = j + 1;
+        }
+      }
+      if (finBloc)
+      {
+        finBloc(debut, fin);
+      }
+    });
+  };
+
+  /*
+    Function to calculate evolutionary distances directly into the condensed matrice, by blocks of rows:
+      Distances estimation of a block are calculated with the counting engine ("byte" or "bitsliced")
+      The loop of the pairs is instantiated for the correction of the method ("d": distances estimation) and the policy of the sites,
+      the corrected distance of each pair is read in a table indexed by its counts
+      Finished blocks are released from memory if the matrice is stocked in a file
+      With a cache, counts are read from the cache file (no counting) or written in it for the next runs
+      With lignes, the matrice has one sequence per element of lignes: the row of the alignment compared (no cache)
+  */
+  void matriceDivergences(const EncodedAlignment& alignement, MatriceCondensee& matrice, int nbThreads, const std::string& moteur,
+    const descripteurMethode& methode, CachePaires* cache = nullptr, const std::vector<int>* lignes = nullptr);
 
-  // Function to stock the lentgh of distances estimation vector
-  int tailleDivergenceObservee(std::vector<double> vecteurDivergenceObservee);
+  /*
+    Function to expand the matrice of the unique sequences to all the sequences of the alignment, by blocks of rows on nbThreads threads:
+      groupes: index of the unique sequence of each sequence in the matrice uniques, lignes: row of the alignment of each unique sequence
+      Two copies of the same sequence get the corrected distance of the sequence with itself (0, or no value without compared site)
+  */
+  void developperMatrice(const EncodedAlignment& alignement, const MatriceCondensee& uniques, const std::vector<int>& lignes,
+    const std::vector<int>& groupes, MatriceCondensee& matrice, int nbThreads, const descripteurMethode& methode);
 
-  // Function to stock evolutinary distances into a matrice (2D array)
-  double **distance(std::vector<double> vecteurDistances, int tailleVecteur);
+  /*
+    Function to update the previous result with the sequences added to the alignment (incremental mode):
+      Distances between two sequences of the previous result are copied
+      Only the pairs with a new sequence (new x old and new x new) are calculated and corrected, on nbThreads threads
+  */
+  void completerMatrice(const EncodedAlignment& alignement, const MatricePrecedente& precedente, MatriceCondensee& matrice, int nbThreads,
+    const std::string& moteur, const descripteurMethode& methode);
 
   /*
-    Function to create seqs.dist output file (3rd argument option "-o" or "--output"):
+    Function to calculate the distance matrices of the bootstrap replicates in one pass over the pairs, by blocks of rows on nbThreads threads:
+      The pairs of a piece of row are counted together in all the replicates (weights of their different and absent columns), then corrected
+      matrices: one matrice per replicate, finished blocks are released from memory if the matrices are stocked in files
+  */
+  void matricesBootstrap(const EncodedAlignment& alignement, const ReplicatsBootstrap& replicats, std::vector<MatriceCondensee>& matrices,
+    int nbThreads, const descripteurMethode& methode);
+
+  /*
+    Function to create seqs.dist output file (3rd argument option "-o" or "--output"), formatted on nbThreads threads:
       Number of amino acids sequences
       Triangular matrice of evolutinary distances
       Header sequences
       Compared sequences and evolutinary distances
   */
-  std::ofstream fichierDist(double **distanceEvolutive, std::vector<double> vecteurDistances, std::vector<fasta> vecFasta, int tailleVecteur);
+  std::ofstream fichierDist(const MatriceCondensee& matrice, const EncodedAlignment& alignement, int nbThreads = 1,
+    const std::string& nomFichier = "seqs.dist");
 
   /*
-    Function to create mat.dist (3rd argument option "-m" or "--matrice"): 
+    Function to create mat.dist (3rd argument option "-m" or "--matrice"), formatted on nbThreads threads:
       Triangular matrice in PHYLIP format
+      ajout true: the matrice is written at the end of the file (PHYLIP multiple data sets, ex. bootstrap replicates)
+  */
+  std::ofstream fichierMat(const MatriceCondensee& matrice, const EncodedAlignment& alignement, int nbThreads = 1,
+    const std::string& nomFichier = "mat.dist", bool ajout = false);
+
+  /*
+    Function to create mat.dist while distances are calculated (3rd argument option "-m" with "-s" or "--stream"):
+      Each row of the PHYLIP matrice is calculated completely (d(i,k) for all k), corrected and formatted on nbThreads threads
+      Rows are written by windows: a window is written by another thread while the next window is calculated
+      Only two windows of formatted rows are in memory, the matrice is never stocked
+  */
+  std::ofstream fichierMatFlux(const EncodedAlignment& alignement, int nbThreads, const std::string& moteur,
+    const descripteurMethode& methode, const std::string& nomFichier = "mat.dist");
+
+  /*
+    Function to write the pairs whose distance is at most distanceMaximum in a sparse file, calculated by windows of rows on nbThreads threads:
+      The correction of the method is inverted into a largest proportion of substitutions: a pair stops its counting as soon as
+      its substitutions exceed this proportion of the compared sites of its sequence with the less compared sites
+      Rows are formatted in parallel and written in order, the matrice is never stocked
+      Return the number of pairs stopped before the end of the alignment
+  */
+  size_t fichierCreux(const EncodedAlignment& alignement, int nbThreads, const std::string& moteur, const descripteurMethode& methode,
+    double distanceMaximum, FichierCreux& fichier);
+
+  /*
+    Function to create mat.bin (3rd argument option "-b" or "--binary"):
+      Versioned header (number of sequences, precision, method, model, hash of the alignment)
+      Names table and condensed matrice in little endian float32 (precision 4) or float64 (precision 8)
   */
-  std::ofstream fichierMat(double **distanceEvolutive, std::vector<double> vecteurDistances, std::vector<fasta> vecFasta, int tailleVecteur);
+  bool fichierBinaire(const MatriceCondensee& matrice, const EncodedAlignment& alignement, const std::string& methode,
+    const std::string& modele, uint32_t precision, const std::string& nomFichier = "mat.bin");
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class EcritureTexte: Fast writing of the text output files, distances formatted with std::to_chars by blocks of rows in parallel.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <charconv>
+
+#include "ecriture.hpp"
+#include "parallele.hpp"
+
+using namespace std;
+
+// Function to add a distance with 6 decimals at the end of tampon (same text as std::fixed and std::setprecision(6))
+void EcritureTexte::ajouterDistance(string& tampon, double distance)
+{
+    // The largest double has 309 digits before the decimal point
+    char nombre[352];
+    // Exact rounding to 6 decimals, "nan", "-nan", "inf" and "-inf" like printf("%f")
+    to_chars_result resultat = to_chars(nombre, nombre + sizeof(nombre), distance, chars_format::fixed, 6);
+    tampon.append(nombre, resultat.ptr - nombre);
+}
+
+// Function to format nbBlocs blocks in parallel with the formater function and write them in order in the file
+void EcritureTexte::ecrireBlocs(ostream& fichier, size_t nbBlocs, const function<void(size_t bloc, string& tampon)>& formater)
+{
+    Parallele parallele(nbThreads);
+
+    // Blocks are formatted by groups of 4 blocks per thread, buffers are used again by the next groups
+    size_t tailleGroupe = (size_t)parallele.nombreThreads() * 4;
+    vector<string> tampons(min(tailleGroupe, nbBlocs));
+
+    for (size_t premier = 0; premier < nbBlocs; premier += tailleGroupe)
+    {
+        size_t nbBlocsGroupe = min(tailleGroupe, nbBlocs - premier);
+        parallele.executer(nbBlocsGroupe, [&](size_t b)
+        {
+            tampons[b].clear();
+            formater(premier + b, tampons[b]);
+        });
+        for (size_t b = 0; b < nbBlocsGroupe; b++)
+        {
+            fichier.write(tampons[b].data(), tampons[b].size());
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class EcritureTexte: Fast writing of the text output files, distances formatted with std::to_chars by blocks of rows in parallel.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef ECRITURE_HPP
+#define ECRITURE_HPP
+
+/*
+ Les blocs de lignes sont formatés en parallèle dans des tampons, puis écrits dans l'ordre.
+ Seul un groupe de quelques blocs par thread est en mémoire en même temps
+*/
+class EcritureTexte
+{
+  private:
+    int nbThreads; // Number of threads to format the blocks
+
+  public:
+    // EcritureTexte Class constructor
+    EcritureTexte(int threads = 1)
+    {
+      nbThreads = threads;
+      journal() << "EcritureTexte Class constructor.\n";
+    };
+
+    // EcritureTexte Class destructor
+    ~EcritureTexte()
+    {
+      journal() << "EcritureTexte Class destructor.\n";
+    };
+
+    // Function to add a distance with 6 decimals at the end of tampon (same text as std::fixed and std::setprecision(6))
+    static void ajouterDistance(std::string& tampon, double distance);
+
+    // Function to format nbBlocs blocks in parallel with the formater function and write them in order in the file
+    void ecrireBlocs(std::ostream& fichier, size_t nbBlocs, const std::function<void(size_t bloc, std::string& tampon)>& formater);
+};
+#endif
@@ -24,16 +24,22 @@
 #include <vector>
 #include <string.h>
 #include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fasta.hpp"
+#include "compression.hpp"
 
 using namespace std;
 
 // Function to print the Help manual
 void Fasta::usage(int argc, char **argv)
 {
-    cout << "Usage: "<< argv[0] << " [evolutionary distances method option] aligned FASTA file [output file option] \n"
+    cout << "Usage: "<< argv[0] << " [evolutionary distances method option] aligned FASTA file [output file option] [other options] \n"
         << "Program in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice.\n"
+        << "The FASTA file can be compressed with gzip or bgzip (BGZF).\n"
         << "Evolutionary distances methods options:\n"
         << "-d, --divergence         Distance estimation [Default].\n"
         << "-h, --help               Display informations about the program.\n"
@@ -70,10 +76,41 @@ void Fasta::usage(int argc, char **argv)
         << "VT\n"
         << "WAG\n"
         << "WAG*\n"
+        << "-S, --model MODEL        Amino acids substitution model of the Poisson Correction and Equal-Input methods [Default: Dayhoff], unknown models are refused.\n"
         << "\n"
         << "Output file options:\n"
         << "-m, --matrice            Output file mat.dist, with a triangular distance matrice in PHYLIP format.\n"
         << "-o, --output             Output file seqs.dist, with a distance matrice and other informations: number of sequences, evolutionary distances and header sequences.\n"
+        << "-b, --binary             Output file mat.bin, with a binary condensed distance matrice (header, names table, little endian float64 or float32 distances).\n"
+        << "\n"
+        << "Other options:\n"
+        << "-t, --threads N          Number of threads to calculate distances estimation (0: all cores) [Default: 1].\n"
+        << "-e, --engine ENGINE      Counting engine: byte (SIMD comparison of sites) [Default] or bitsliced (one bitset per amino acid, popcount).\n"
+        << "-D, --disk FILE          Distance matrice stocked in FILE mapped in memory, written by blocks of rows (very large alignments).\n"
+        << "-f, --float BITS         Precision of the binary output file: 64 (float64) [Default] or 32 (float32).\n"
+        << "-s, --stream             With -m: rows of mat.dist are calculated and written by windows while the next rows are calculated (the matrice is not stocked).\n"
+        << "-M, --methods LIST       Several methods from one counting pass, separated by commas (ex. d,p,k,jc,pc:LG,ei:WAG): one output file per method\n"
+        << "                         (ex. mat.p.dist, mat.pc-LG.dist), the method option is not used.\n"
+        << "-c, --cache DIR          Pair counts (substitutions, compared sites) cached in DIR, keyed by the hash of the alignment and the gap policy:\n"
+        << "                         the next runs on the same alignment read the counts instead of comparing the sequences.\n"
+        << "-u, --update FILE        Previous result (mat.bin or mat.dist) updated with the sequences added to the alignment: only the pairs with a new sequence\n"
+        << "                         are calculated (gaps must be kept). A PHYLIP previous result needs --update-phylip.\n"
+        << "--update-phylip          Accept a PHYLIP previous result with -u: its method and the residues of its sequences can't be checked.\n"
+        << "-g, --ignore-gaps        Remove all the alignment columns with a gap [Default: gaps are kept].\n"
+        << "-G, --max-gaps PERCENT   Remove the alignment columns with more than PERCENT % of gaps and unknown amino acids (X).\n"
+        << "-W, --patterns           Compress identical columns in weighted site patterns before the counting (same distances).\n"
+        << "--bootstrap R            R bootstrap replicates (columns drawn with replacement) calculated in one pass over the pairs: one output file per replicate\n"
+        << "                         (ex. mat.b001.dist), the distances of the alignment are not calculated.\n"
+        << "--seed S                 Seed of the draw of the bootstrap replicates [Default: 1].\n"
+        << "--concatenate            With --bootstrap and -m: the replicates are written one after the other in mat.bootstrap.dist (PHYLIP multiple data sets).\n"
+        << "--max-distance D         Only the pairs whose distance is at most D are written (i, j, distance) in mat.sparse.dist, or mat.sparse.bin with -b:\n"
+        << "                         the counting of a pair stops as soon as its substitutions are too many (the matrice is not stocked).\n"
+        << "-B, --batch              Batch mode: the FASTA file argument is a directory of aligned FASTA files or a manifest (one path per line).\n"
+        << "                         Alignments share one pool of threads, largest first; output files are named with the family (ex. PF00001.mat.dist).\n"
+        << "-O, --outdir DIR         Directory of the output files in batch mode [Default: current directory].\n"
+        << "--metrics FILE           Performance measures in the JSON file FILE: wall-clock and CPU time of each stage, pairs, sites, bytes read and written, peak memory.\n"
+        << "--perf                   With --metrics: hardware counters of each stage (cycles, last level cache misses) with perf_event_open.\n"
+        << "-P, --progress           Progress of the distances on the error output: pairs calculated, pairs/s and estimated remaining time.\n"
         << endl;
 }
 
@@ -157,9 +194,9 @@ int Fasta::tailleFasta(vector<fasta> vecFasta)
 bool Fasta::superieurAtrois(vector<fasta> vecFasta)
 {
     // Variable to count the number of sequences in struct fasta
-    int compteur;
+    int compteur = 0;
 
-    for(int i = 0; i < vecFasta.size(); i++)
+    for(size_t i = 0; i < vecFasta.size(); i++)
     {
         compteur++;
     }
@@ -198,62 +235,37 @@ bool Fasta::tailleSequence(vector<fasta> vecFasta, int tailleVecteur)
 // Function to create a new alignment with no gaps in columns
 vector<fasta> Fasta::ignoreAllGaps(vector<fasta> vecFasta, int tailleVecteur)
 {
-    // Iterate gaps loop
-    int g = 0;
-
-    // Gaps positions vector
-    vector<int> gaps;
-
-    // New vector and variable for sequences alignement
-    string newSequence;
-    vector<string> newAlignement;
-
-    // Get gaps positions into alignment columns
-    while (g <= tailleVecteur-1){
-        string sequenceComparee = vecFasta[g].s; // Iteration through compared sequence
-        int tailleSequence = sequenceComparee.length(); // Variable length of comapared sequence
-        for (int k = 0; k <= tailleSequence; k++) 
-        {
-            // If it's a gap site, it's alignement position is stocked in gaps' vector
-            if (sequenceComparee[k] == '-') 
-            {
-                // Check if gap position is not already in the vector
-                if (find(gaps.begin(), gaps.end(), k) == gaps.end()){
-                    gaps.push_back(k);
-                }
-            }
-        }
-        g++;
+    // Length of the alignment (length of the longest sequence)
+    size_t tailleSequence = 0;
+    for (int g = 0; g < tailleVecteur; g++)
+    {
+        tailleSequence = max(tailleSequence, vecFasta[g].s.length());
     }
 
-    // New alignment's loop iterator 
-    int a = 0;
-
-    // Creation of the new alignment without gaps
-    while (a <= tailleVecteur-1){
-        string sequenceComparee = vecFasta[a].s;  // Iteration through compared sequence
-        int tailleSequence = sequenceComparee.length(); // Variable length of comapared sequence
-        for (int k = 0; k < tailleSequence; k++) 
+    // Mask of the columns with a gap in at least one sequence: one pass on each sequence
+    vector<uint8_t> gaps(tailleSequence, 0);
+    for (int g = 0; g < tailleVecteur; g++)
+    {
+        const string& sequenceComparee = vecFasta[g].s; // Iteration through compared sequence
+        for (size_t k = 0; k < sequenceComparee.length(); k++)
         {
-            // If site position is already in gaps vector, it's ignored
-            if (find(gaps.begin(), gaps.end(), k) != gaps.end()){
-                continue;
-            }else{
-                // Else add the site to the new sequence
-                newSequence += sequenceComparee[k];
-            } 
+            gaps[k] |= (sequenceComparee[k] == '-');
         }
-        // Add new sequence in new alignment vector
-        newAlignement.push_back(newSequence);
-        newSequence.clear();
-        a++;
     }
 
-
-    // Remplace sequences without gaps in struct fasta
-    for (int i = 0; i < newAlignement.size(); i++)
+    // Creation of the new alignment without gaps: sites of the kept columns are moved in place
+    for (int a = 0; a < tailleVecteur; a++)
     {
-        vecFasta[i].s = newAlignement[i];
+        string& sequenceComparee = vecFasta[a].s;
+        size_t c = 0;
+        for (size_t k = 0; k < sequenceComparee.length(); k++)
+        {
+            if (!gaps[k])
+            {
+                sequenceComparee[c++] = sequenceComparee[k];
+            }
+        }
+        sequenceComparee.resize(c);
     }
 
     return vecFasta; // Return new alignment with no gaps in columns
@@ -281,4 +293,249 @@ fasta* Fasta::tableauFasta(vector<fasta> vecFasta, int tailleVecteur)
     }
     // Return 1D dynamic with elements of struct fasta
     return tableauStruct;
+}
+
+// FastaMappe Class constructor: map the FASTA file (decompressed on nbThreads threads if needed) and find headers and sequences
+FastaMappe::FastaMappe(const char* chemin, int nbThreads)
+{
+    donnees = NULL;
+    taille = 0;
+    mappe = false;
+    lu = false;
+    transitoire = false;
+    numero = 0;
+    numerotation = 0;
+
+    int descripteur = open(chemin, O_RDONLY);
+    if (descripteur >= 0)
+    {
+        struct stat infos;
+        if ((fstat(descripteur, &infos) == 0) && S_ISREG(infos.st_mode))
+        {
+            lu = true;
+            taille = infos.st_size;
+            // An empty file can't be mapped, it has no sequences
+            if (taille > 0)
+            {
+                void* projection = mmap(NULL, taille, PROT_READ, MAP_PRIVATE, descripteur, 0);
+                if (projection != MAP_FAILED)
+                {
+                    // The file is read once from the beginning to the end
+                    madvise(projection, taille, MADV_SEQUENTIAL);
+                    donnees = (const char*)projection;
+                    mappe = true;
+                }else{
+                    lu = false;
+                }
+            }
+        }else{
+            // The file can't be mapped (pipe, special file): it is read into a buffer
+            char bloc[1 << 16];
+            ssize_t lus;
+            while ((lus = read(descripteur, bloc, sizeof(bloc))) > 0)
+            {
+                tampon.append(bloc, lus);
+            }
+            lu = (lus == 0);
+            donnees = tampon.data();
+            taille = tampon.size();
+        }
+        close(descripteur);
+    }
+
+    if (lu && Compression::compresse(donnees, taille))
+    {
+        // Compressed file (gzip or BGZF): decompressed parts are given to the reader, no temporary file
+        transitoire = true;
+        Compression compression(nbThreads);
+        lu = compression.decompresser(donnees, taille, [this](const char* debut, size_t longueur)
+        {
+            alimenter(debut, longueur);
+        });
+        // The last line of the file has no end of line
+        if (!reste.empty())
+        {
+            ligne(reste);
+        }
+        if (!lu)
+        {
+            cerr << "Error: the compressed FASTA file can't be decompressed.\n";
+        }
+    }else if (lu)
+    {
+        analyser(donnees, taille);
+    }
+    // The last sequence of the file is stock
+    if (lu && !entete.empty())
+    {
+        stocker();
+    }
+    if (!lu)
+    {
+        cerr << "Error: the FASTA file can't be open.\n";
+    }
+    journal() << "FastaMappe Class constructor.\n";
+}
+
+// FastaMappe Class destructor: unmap the FASTA file
+FastaMappe::~FastaMappe()
+{
+    if (mappe)
+    {
+        munmap((void*)donnees, taille);
+    }
+    journal() << "FastaMappe Class destructor.\n";
+}
+
+// Function to stock the current sequence: a sequence on one line is not copied, a sequence on several lines is joined once
+void FastaMappe::stocker()
+{
+    vueFasta stockage;
+    stockage.e = entete;
+    stockage.n = numero;
+    if (transitoire)
+    {
+        copies.push_back(std::move(sequenceCopiee));
+        sequenceCopiee = string();
+        stockage.s = copies.back();
+    }else if (morceaux.size() == 1)
+    {
+        stockage.s = morceaux[0];
+    }else if (morceaux.size() > 1)
+    {
+        size_t tailleSequence = 0;
+        for (size_t m = 0; m < morceaux.size(); m++)
+        {
+            tailleSequence += morceaux[m].size();
+        }
+        copies.emplace_back();
+        copies.back().reserve(tailleSequence);
+        for (size_t m = 0; m < morceaux.size(); m++)
+        {
+            copies.back().append(morceaux[m].data(), morceaux[m].size());
+        }
+        stockage.s = copies.back();
+    }
+    vues.push_back(stockage);
+}
+
+// Function to read one line of the FASTA file (same rules as Fasta::vecteurFasta)
+void FastaMappe::ligne(string_view texte)
+{
+    // If a line is empty, begin with a ">" and the header is not empty, the sequence is stocked.
+    if (texte.empty() || texte[0] == '>')
+    {
+        if (!entete.empty())
+        {
+            stocker();
+            entete = string_view();
+        }
+        // If the line is not empty the header is stock
+        if (!texte.empty())
+        {
+            if (transitoire)
+            {
+                copies.emplace_back(texte.substr(1));
+                entete = copies.back();
+            }else{
+                entete = texte.substr(1);
+            }
+            numero = numerotation++;
+        }
+        morceaux.clear();
+        sequenceCopiee.clear();
+    // Else if header is not empty and sequences continue on multiple lines, they are concatenated
+    }else if (!entete.empty())
+    {
+        if (memchr(texte.data(), ' ', texte.size()) != NULL)
+        {
+            entete = string_view();
+            morceaux.clear();
+            sequenceCopiee.clear();
+        }else if (transitoire)
+        {
+            sequenceCopiee.append(texte.data(), texte.size());
+        }else{
+            morceaux.push_back(texte);
+        }
+    }
+}
+
+// Function to find headers and sequences in a part of the file content
+void FastaMappe::analyser(const char* debut, size_t longueur)
+{
+    const char* position = debut;
+    const char* finFichier = debut + longueur;
+    while (position < finFichier)
+    {
+        // Next end of line (memchr uses SIMD instructions)
+        const char* finLigne = (const char*)memchr(position, '\n', finFichier - position);
+        if (finLigne == NULL)
+        {
+            finLigne = finFichier;
+        }
+        ligne(string_view(position, finLigne - position));
+        position = finLigne + 1;
+    }
+}
+
+// Function to give the next decompressed part of the file to the reader
+void FastaMappe::alimenter(const char* debut, size_t longueur)
+{
+    const char* finPartie = debut + longueur;
+
+    // The line not finished in the last part ends in this part
+    if (!reste.empty())
+    {
+        const char* finLigne = (const char*)memchr(debut, '\n', longueur);
+        if (finLigne == NULL)
+        {
+            reste.append(debut, longueur);
+            return;
+        }
+        reste.append(debut, finLigne - debut);
+        ligne(reste);
+        reste.clear();
+        debut = finLigne + 1;
+    }
+
+    // Complete lines of the part, the last line not finished is kept for the next part
+    const char* position = debut;
+    while (position < finPartie)
+    {
+        const char* finLigne = (const char*)memchr(position, '\n', finPartie - position);
+        if (finLigne == NULL)
+        {
+            break;
+        }
+        ligne(string_view(position, finLigne - position));
+        position = finLigne + 1;
+    }
+    reste.assign(position, finPartie - position);
+}
+
+// Function to check if the number of sequences of the mapped FASTA file is strictly superior to 3
+bool Fasta::superieurAtrois(const vector<vueFasta>& vecFasta)
+{
+    if (vecFasta.size() < 3){
+        cerr << "Error: The number of sequences must be equal or superior to 3 to create an evolutinary distance matrice.\n";
+        return false;
+    }
+    return true;
+}
+
+// Function to check if sequences of the mapped FASTA file are aligned
+bool Fasta::tailleSequence(const vector<vueFasta>& vecFasta, int tailleVecteur)
+{
+    // All sequences must have the length of the first sequence
+    for (int i = 1; i < tailleVecteur; i++)
+    {
+        if (vecFasta[i].s.size() != vecFasta[0].s.size())
+        {
+            // If sequences haven't the same length, they are not aligned: exit program
+            cerr << "Error: Amino acids sequences are not aligned.\n";
+            return false;
+        }
+    }
+    return true; // If sequences are aligned return true
 }
\ No newline at end of file
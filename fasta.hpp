@@ -21,8 +21,13 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
 #include <string.h>
 
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
 #ifndef FASTA_HPP
 #define FASTA_HPP
 
@@ -38,19 +43,96 @@ struct fasta
 };
 
 
+/*
+ Structure pour contenir les informations d'une séquence d'un fichier FASTA projeté en mémoire.
+ L'entête et la séquence sont des vues dans le fichier projeté (ou dans une copie si la séquence est sur plusieurs lignes)
+*/
+struct vueFasta
+{
+  std::string_view e; // Header
+  int n; // Header number
+  std::string_view s; // Sequence
+};
+
+/*
+ Fichier FASTA projeté en mémoire (mmap): les entêtes et les séquences ne sont pas copiés.
+ Seules les séquences écrites sur plusieurs lignes sont copiées pour les joindre.
+ Un fichier compressé (gzip ou BGZF) est décompressé en mémoire et donné au lecteur par morceaux: les entêtes et les séquences sont alors copiés
+*/
+class FastaMappe
+{
+  private:
+    const char* donnees; // File content
+
+    size_t taille; // File length
+
+    bool mappe; // True if the file is mapped with mmap, false if it is read into tampon
+
+    bool lu; // True if the file can be read
+
+    std::string tampon; // File content if the file can't be mapped (pipe, special file)
+
+    std::vector<vueFasta> vues; // Headers and sequences
+
+    std::deque<std::string> copies; // Sequences on several lines joined, headers and sequences of compressed files
+
+    bool transitoire; // True if the lines are not kept in memory (decompressed parts): they are copied
+
+    std::string_view entete; // Header of the current sequence
+
+    int numero; // Header number of the current sequence
+
+    int numerotation; // Variable to number headers
+
+    std::vector<std::string_view> morceaux; // Lines of the current sequence
+
+    std::string sequenceCopiee; // Current sequence if lines are copied
+
+    std::string reste; // End of the last decompressed part (line not finished)
+
+    // Function to read one line of the FASTA file (same rules as Fasta::vecteurFasta)
+    void ligne(std::string_view texte);
+
+    // Function to stock the current sequence
+    void stocker();
+
+    // Function to find headers and sequences in a part of the file content
+    void analyser(const char* debut, size_t longueur);
+
+    // Function to give the next decompressed part of the file to the reader
+    void alimenter(const char* debut, size_t longueur);
+
+  public:
+    // FastaMappe Class constructor: map the FASTA file (decompressed on nbThreads threads if needed) and find headers and sequences
+    FastaMappe(const char* chemin, int nbThreads = 1);
+
+    // FastaMappe Class destructor: unmap the FASTA file
+    ~FastaMappe();
+
+    // The mapped file is not shared between two objects
+    FastaMappe(const FastaMappe&) = delete;
+    FastaMappe& operator=(const FastaMappe&) = delete;
+
+    // Function to check if the FASTA file can be read
+    bool ouvert() const { return lu; };
+
+    // Function to get headers and sequences of the FASTA file
+    const std::vector<vueFasta>& sequences() const { return vues; };
+};
+
 class Fasta
 {
   public:
     // Fasta Class constructor
     Fasta()
     {
-      std::cout << "Fasta Class constructor.\n";
+      journal() << "Fasta Class constructor.\n";
     };
 
     // Fasta Class destructor
     ~Fasta()
     {
-      std::cout << "Fasta Class destructor.\n";
+      journal() << "Fasta Class destructor.\n";
     };
 
     // Function to print the Help manual.
@@ -71,6 +153,12 @@ class Fasta
     // Function to check if sequences are aligned
     bool tailleSequence(std::vector<fasta> vecFasta, int tailleVecteur);
 
+    // Function to check if the number of sequences of the mapped FASTA file is strictly superior to 3
+    bool superieurAtrois(const std::vector<vueFasta>& vecFasta);
+
+    // Function to check if sequences of the mapped FASTA file are aligned
+    bool tailleSequence(const std::vector<vueFasta>& vecFasta, int tailleVecteur);
+
     // Function to create a new alignment with no gaps in columns
     std::vector<fasta> ignoreAllGaps(std::vector<fasta> vecFasta, int tailleVecteur);
 
@@ -0,0 +1,171 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatricePrecedente: Previous result (binary mat.bin or PHYLIP mat.dist) used to update the distance matrice when sequences are added.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <charconv>
+#include <unordered_map>
+
+#include "incremental.hpp"
+
+using namespace std;
+
+// MatricePrecedente Class constructor: read the previous result (binary or PHYLIP format)
+MatricePrecedente::MatricePrecedente(const char* chemin)
+{
+    valide = false;
+    binaire.reset(new MatriceBinaire(chemin));
+    if (binaire->ouvert())
+    {
+        valide = true;
+        return;
+    }
+    // Not a binary distance matrice: PHYLIP format
+    binaire.reset();
+    valide = lirePhylip(chemin);
+}
+
+// Function to read a previous result in PHYLIP format
+bool MatricePrecedente::lirePhylip(const char* chemin)
+{
+    ifstream fichier(chemin);
+    int n = 0;
+    if (!fichier.is_open() || !(fichier >> n) || (n <= 0))
+    {
+        return false;
+    }
+    string ligne;
+    getline(fichier, ligne);
+    texte = MatriceCondensee(n);
+    double* distances = texte.donnees();
+
+    // Rows: name then n distances separated by tabulations, only the upper triangle is kept
+    for (int i = 0; i < n; i++)
+    {
+        if (!getline(fichier, ligne))
+        {
+            return false;
+        }
+        size_t espace = ligne.find(' ');
+        if (espace == string::npos)
+        {
+            return false;
+        }
+        noms.push_back(ligne.substr(0, espace));
+        const char* position = ligne.data() + espace + 1;
+        const char* fin = ligne.data() + ligne.size();
+        for (int k = 0; k < n; k++)
+        {
+            while ((position < fin) && ((*position == '\t') || (*position == ' ')))
+            {
+                position++;
+            }
+            double distance = 0.0;
+            from_chars_result resultat = from_chars(position, fin, distance);
+            if (resultat.ec != errc())
+            {
+                return false;
+            }
+            position = resultat.ptr;
+            if (k > i)
+            {
+                distances[texte.index(i, k)] = distance;
+            }
+        }
+    }
+    return true;
+}
+
+// Function to stock the number of sequences of the previous result
+int MatricePrecedente::nombreSequences() const
+{
+    return binaire ? binaire->nombreSequences() : texte.nombreSequences();
+}
+
+// Function to get the method of the previous result (binary file only)
+string MatricePrecedente::methode() const
+{
+    return binaire ? binaire->methode() : "";
+}
+
+// Function to get the model of the previous result (binary file only)
+string MatricePrecedente::modele() const
+{
+    return binaire ? binaire->modele() : "";
+}
+
+// Function to find each sequence of the alignment in the previous result (index in the previous result, -1: new sequence)
+vector<int> MatricePrecedente::correspondances(const EncodedAlignment& alignement) const
+{
+    vector<int> anciens(alignement.nombreSequences(), -1);
+    if (binaire)
+    {
+        // Same header and same residues: same hash
+        unordered_map<uint64_t, int> empreintes;
+        for (int k = 0; k < binaire->nombreSequences(); k++)
+        {
+            empreintes[binaire->empreinteSequence(k)] = k;
+        }
+        for (int i = 0; i < alignement.nombreSequences(); i++)
+        {
+            auto trouve = empreintes.find(alignement.empreinteSequence(i));
+            if ((trouve != empreintes.end()) && (binaire->nom(trouve->second) == alignement.entete(i)))
+            {
+                anciens[i] = trouve->second;
+            }
+        }
+    }else{
+        // Same first word of the header (a name found several times is not used)
+        unordered_map<string, int> indexNoms;
+        for (int k = 0; k < (int)noms.size(); k++)
+        {
+            auto trouve = indexNoms.find(noms[k]);
+            indexNoms[noms[k]] = (trouve == indexNoms.end()) ? k : -1;
+        }
+        for (int i = 0; i < alignement.nombreSequences(); i++)
+        {
+            auto trouve = indexNoms.find(alignement.entete(i).substr(0, alignement.entete(i).find(" ")));
+            if (trouve != indexNoms.end())
+            {
+                anciens[i] = trouve->second;
+            }
+        }
+    }
+
+    // A sequence of the previous result is used only once
+    vector<bool> utilises(nombreSequences(), false);
+    for (int i = 0; i < alignement.nombreSequences(); i++)
+    {
+        if (anciens[i] >= 0)
+        {
+            if (utilises[anciens[i]])
+            {
+                anciens[i] = -1;
+            }else{
+                utilises[anciens[i]] = true;
+            }
+        }
+    }
+    return anciens;
+}
@@ -0,0 +1,79 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatricePrecedente: Previous result (binary mat.bin or PHYLIP mat.dist) used to update the distance matrice when sequences are added.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "alignement.hpp" // alignement.hpp inclusion to use the headers and the hash of the sequences
+#include "matrice.hpp" // matrice.hpp inclusion to stock the distances of a PHYLIP file
+#include "binaire.hpp" // binaire.hpp inclusion to read a binary distance matrice
+
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+/*
+ Résultat précédent d'Align:
+   Fichier binaire: les séquences sont reconnues par l'empreinte de leur en-tête et de leurs résidus
+   Fichier PHYLIP: les séquences sont reconnues par le premier mot de leur en-tête (les résidus ne sont pas dans le fichier)
+*/
+class MatricePrecedente
+{
+  private:
+    std::unique_ptr<MatriceBinaire> binaire; // Previous binary result (mapped file)
+
+    MatriceCondensee texte; // Distances of the previous PHYLIP result
+
+    std::vector<std::string> noms; // Names of the previous PHYLIP result
+
+    bool valide; // True if the previous result can be read
+
+    // Function to read a previous result in PHYLIP format
+    bool lirePhylip(const char* chemin);
+
+  public:
+    // MatricePrecedente Class constructor: read the previous result (binary or PHYLIP format)
+    MatricePrecedente(const char* chemin);
+
+    // Function to check if the previous result can be read
+    bool ouvert() const { return valide; };
+
+    // Function to check if the previous result is a binary file (method, model and hash of the sequences are known)
+    bool estBinaire() const { return binaire != nullptr; };
+
+    // Function to stock the number of sequences of the previous result
+    int nombreSequences() const;
+
+    // Function to get the method and the model of the previous result (binary file only)
+    std::string methode() const;
+    std::string modele() const;
+
+    // Function to get the distance between the sequences i and j of the previous result
+    double valeur(int i, int j) const
+    {
+      return binaire ? binaire->valeur(i, j) : texte.valeur(i, j);
+    };
+
+    // Function to find each sequence of the alignment in the previous result (index in the previous result, -1: new sequence)
+    std::vector<int> correspondances(const EncodedAlignment& alignement) const;
+};
+#endif
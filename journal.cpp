@@ -0,0 +1,45 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Messages of the library: constructors and stages of the calculations, written on std::cout only if the client enables them.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <atomic>
+
+#include "journal.hpp"
+
+using namespace std;
+
+// Messages of the library enabled (align client) or disabled (default)
+static atomic<bool> journalActif(false);
+
+// Function to enable or disable the messages of the library (disabled by default)
+void activerJournal(bool actif)
+{
+    journalActif = actif;
+}
+
+// Function to get the stream of the messages of the library: std::cout if they are enabled, a stream without output otherwise
+ostream& journal()
+{
+    // Stream without buffer: the messages are not formatted and not written
+    static ostream sansSortie(nullptr);
+    return journalActif ? cout : sansSortie;
+}
@@ -7,11 +7,30 @@
         * Kimura estimation for PAM model.
         * Estimation models for evolutionary distances between amino acids sequences: Poisson Correction and Equal-Input (27 amino acids substitution models).
     
-    ./align [evolutionary distances method option] aligned FASTA file [output file option]
+    The distances are calculated by the Align library (class DistanceEngine, libalign.a or libalign.so): this file only reads the
+    command line and the FASTA files, and writes the output files.
 
-    Two options are available for the output file:
+    ./align [evolutionary distances method option] aligned FASTA file (can be compressed with gzip or bgzip) [output file option] [other options]
+
+    Three options are available for the output file:
         * Output file mat.dist, with a triangular distance matrice in PHYLIP format.
         * Output file seqs.dist, with a distance matrice and other informations: number of sequences, evolutionary distances and header sequences.
+        * Output file mat.bin, with the condensed distance matrice in binary format (can be read with mmap, class MatriceBinaire).
+
+    Other options:
+        * Number of threads to calculate distances estimation.
+        * Counting engine: SIMD comparison of bytes or bitsliced alignment.
+        * Distance matrice stocked in a file mapped in memory (very large alignments).
+        * Precision of the binary output file (float32 or float64).
+        * Streaming mode: rows of mat.dist written while distances are calculated.
+        * Several methods calculated from one counting pass, one output file per method.
+        * Cache of the pair counts, used again by the next runs on the same alignment.
+        * Incremental update of a previous result with the sequences added to the alignment.
+        * Substitution model and gap policy (no question on the standard input).
+        * Batch mode: directory or manifest of aligned FASTA files calculated on one pool of threads, one output file per family.
+        * Bootstrap replicates: matrices of columns drawn with replacement, all replicates calculated in one pass over the pairs.
+        * Sparse output of the pairs below a distance threshold, the counting of the other pairs is stopped early.
+        * Performance measures of each stage in a JSON file (time, counters, peak memory, hardware counters) and progress.
 
     Author: Noëlie PALERMO
 
@@ -34,22 +53,364 @@
 #include <string.h>
 #include <bits/stdc++.h>
 
-#include "fasta.cpp"
-#include "divergence.cpp"
-#include "methode.cpp"
+#include "fasta.hpp"
+#include "alignement.hpp"
+#include "parallele.hpp"
+#include "divergence.hpp"
+#include "methode.hpp"
+#include "moteur.hpp"
+#include "mesures.hpp"
+#include "journal.hpp"
 
 using namespace std;
 
-int main(int argc, char** argv){
-    // Calculate execution time of the program
-    clock_t start, end;
-    start = clock();
+/*
+ Options de la ligne de commande, communes à tous les alignements du mode batch
+*/
+struct optionsAlign
+{
+  std::string sortie; // Output file option: "-m", "-o" or "-b"
+  descripteurMethode methode; // Evolutionary distances method, substitution model and parameters alpha and beta
+  optionsMoteur calcul; // Threads, counting engine, gap policy, matrice on disk and pair counts cache
+  uint32_t precision = 8; // Bytes per distance in the binary file: 4 (float32) or 8 (float64)
+  bool flux = false; // Rows of mat.dist written while distances are calculated (the matrice is not stocked)
+  std::string fichierPrecedent; // Previous result (mat.bin or mat.dist) updated with the new sequences (empty: all pairs are calculated)
+  bool accepterPhylip = false; // A PHYLIP previous result is accepted (its method and the residues of its sequences can't be checked)
+  std::string listeMethodes; // Methods calculated from one counting pass (ex. "d,p,k,jc,pc:LG,ei:WAG"), one output file per method
+  int nbReplicats = 0; // Number of bootstrap replicates (0: distances of the alignment)
+  uint64_t graine = 1; // Seed of the draw of the bootstrap replicates
+  bool concatener = false; // Matrices of the bootstrap replicates written one after the other in one PHYLIP file
+  double distanceMaximum = -1.0; // Only the pairs whose distance is at most distanceMaximum are written in a sparse file (negative: whole matrice)
+};
+
+// Function to write the output file of a distance matrice (ex. prefixe "PF00001." and suffixe ".pc-LG" give PF00001.mat.pc-LG.dist)
+void ecrireSortie(const MatriceCondensee& matrice, const EncodedAlignment& alignement, const optionsAlign& options,
+    const descripteurMethode& m, const string& prefixe, const string& suffixe)
+{
+    Divergence divergence; // Object class Divergence 
+
+    chronoEtape etape("write");
+    const string& sortie = options.sortie;
+    int nbThreads = options.calcul.nbThreads;
+    string nomFichier;
+    if ((sortie == "-o") || (sortie == "--output"))
+    {
+        nomFichier = prefixe + "seqs" + suffixe + ".dist";
+        divergence.fichierDist(matrice, alignement, nbThreads, nomFichier);
+        cout << "Creation of " << nomFichier << " file (evolutionary distances matrice informations).\n";
+    }else if ((sortie == "-m") || (sortie == "--matrice"))
+    {
+        nomFichier = prefixe + "mat" + suffixe + ".dist";
+        divergence.fichierMat(matrice, alignement, nbThreads, nomFichier);
+        cout << "Creation of " << nomFichier << " file (evolutionary distances matrice, PHYLIP format).\n";
+    }else if ((sortie == "-b") || (sortie == "--binary"))
+    {
+        nomFichier = prefixe + "mat" + suffixe + ".bin";
+        divergence.fichierBinaire(matrice, alignement, m.nom, m.modele, options.precision, nomFichier);
+        cout << "Creation of " << nomFichier << " file (evolutionary distances matrice, binary format).\n";
+    }
+    error_code erreur;
+    uintmax_t octets = filesystem::file_size(nomFichier, erreur);
+    Mesures::globales().ajouterEcrits(erreur ? 0 : octets);
+}
 
+/*
+ Function to calculate the distance matrice of one aligned FASTA file with the library (DistanceEngine) and write its output file:
+   prefixe: added before the names of the output files (ex. "resultats/PF00001." in batch mode, empty otherwise)
+ Return false if the FASTA file can't be used (errors are printed on cerr, the program is not stopped)
+*/
+bool traiterAlignement(const char* cheminFasta, const optionsAlign& options, const string& prefixe)
+{
     Fasta fichier; // Object class Fasta 
 
-    Divergence divergence; // Object class Divergence 
+    cout << "Checking existence of the FASTA file...\n";
+    // FASTA file mapped in memory (gzip and BGZF files are decompressed): headers and sequences are read without copy
+    unique_ptr<FastaMappe> fichierMappe;
+    {
+        chronoEtape etape("read");
+        fichierMappe.reset(new FastaMappe(cheminFasta, options.calcul.nbThreads));
+    }
+    // If FASTA file exists, then stock sequences and headers
+    if (!fichierMappe->ouvert())
+    {
+        cerr << "Error: the FASTA file " << cheminFasta << " can't be open.\n";
+        return false;
+    }
+    cout << "The FASTA file exists.\n";
+    error_code erreur;
+    uintmax_t octets = filesystem::file_size(cheminFasta, erreur);
+    Mesures::globales().ajouterLus(erreur ? 0 : octets);
+
+    const vector<vueFasta>& vecFasta = fichierMappe->sequences(); // Headers and sequences of the FASTA file
+    int tailleVecteur = vecFasta.size(); // Number of sequences
+    cout << endl;
+    {
+        chronoEtape etape("validation");
+        /*
+        Checking if the number of sequences in the FASTA file is strictly superior to 3
+        */
+        if (!fichier.superieurAtrois(vecFasta))
+        {
+            return false;
+        }
+        cout << "The number of amino acids sequences is sufficient to construct distance matrice.\n";
+
+        cout << endl;
+
+        cout << "Checking sequences alignement...\n";
+        // Checking if sequences are aligned 
+        if (!fichier.tailleSequence(vecFasta, tailleVecteur))
+        {
+            return false;
+        }
+        cout << "Amino acids sequences are aligned.\n";
+        cout << endl;
+    }
+
+    // Encoded alignment: sequences are encoded once from the mapped file into one contiguous buffer used by all next steps
+    unique_ptr<EncodedAlignment> encode;
+    {
+        chronoEtape etape("encode");
+        encode.reset(new EncodedAlignment(vecFasta));
+    }
+    EncodedAlignment& alignement = *encode;
+    if (alignement.nombreSequences() != tailleVecteur)
+    {
+        return false;
+    }
+
+    // Distance engine of the library: gap policy, cache, counting and corrections
+    DistanceEngine moteur(options.calcul);
+
+    /*
+    Several methods: distances estimation are calculated once, then each method is applied on a copy
+    of the matrice and written in its own file (ex. mat.p.dist, mat.pc-LG.dist)
+    */
+    if (!options.listeMethodes.empty())
+    {
+        Methode methode; // Object class Methode 
+        vector<descripteurMethode> methodes = methode.descripteurs(options.listeMethodes);
+        if (methodes.empty())
+        {
+            return false;
+        }
+        cout << endl;
+
+        MatriceCondensee matriceDivergences = moteur.divergences(alignement);
+        if (matriceDivergences.nombreSequences() != tailleVecteur)
+        {
+            return false;
+        }
+        cout << "Distances estimation are calculate (one pass for " << methodes.size() << " methods).\n";
+        cout << endl;
+
+        for (const descripteurMethode& m : methodes)
+        {
+            string suffixe = Methode::suffixe(m);
+            string fichierMatrice = options.calcul.fichierMatrice.empty() ? "" : options.calcul.fichierMatrice + "." + suffixe;
+            // The matrice of the method is released before the next one
+            MatriceCondensee matriceMethode = moteur.appliquer(matriceDivergences, m, fichierMatrice);
+            if (matriceMethode.nombreSequences() != tailleVecteur)
+            {
+                return false;
+            }
+            ecrireSortie(matriceMethode, alignement, options, m, prefixe, "." + suffixe);
+        }
+        return true;
+    }
+
+    /*
+    Sparse output: only the pairs whose distance is at most the threshold are written (i, j, distance),
+    in mat.sparse.bin with -b, in mat.sparse.dist otherwise
+    */
+    if (options.distanceMaximum >= 0.0)
+    {
+        bool binaire = (options.sortie == "-b") || (options.sortie == "--binary");
+        string nomFichier = prefixe + (binaire ? "mat.sparse.bin" : "mat.sparse.dist");
+        if (!moteur.ecrireCreux(alignement, options.methode, options.distanceMaximum, nomFichier, binaire ? options.precision : 0))
+        {
+            return false;
+        }
+        cout << "Creation of " << nomFichier << " file (evolutionary distances at most " << options.distanceMaximum << ", sparse format).\n";
+        error_code erreur;
+        uintmax_t octets = filesystem::file_size(nomFichier, erreur);
+        Mesures::globales().ajouterEcrits(erreur ? 0 : octets);
+        return true;
+    }
+
+    /*
+    Bootstrap: the matrices of all the replicates are calculated in one pass over the pairs, then written in one file per replicate
+    (ex. mat.b001.dist) or one after the other in mat.bootstrap.dist (multiple data sets of PHYLIP)
+    */
+    if (options.nbReplicats > 0)
+    {
+        vector<MatriceCondensee> replicats = moteur.bootstrap(alignement, options.methode, options.nbReplicats, options.graine);
+        if (replicats.empty())
+        {
+            return false;
+        }
+        cout << "Creation of " << options.nbReplicats << " bootstrap matrices.\n";
+        cout << endl;
+        if (options.concatener)
+        {
+            Divergence divergence; // Object class Divergence 
+
+            chronoEtape etape("write");
+            string nomFichier = prefixe + "mat.bootstrap.dist";
+            for (int r = 0; r < options.nbReplicats; r++)
+            {
+                divergence.fichierMat(replicats[r], alignement, options.calcul.nbThreads, nomFichier, r > 0);
+                // The matrice of the replicate is released before the next one
+                replicats[r] = MatriceCondensee();
+            }
+            cout << "Creation of " << nomFichier << " file (" << options.nbReplicats << " evolutionary distances matrices, PHYLIP format).\n";
+            error_code erreur;
+            uintmax_t octets = filesystem::file_size(nomFichier, erreur);
+            Mesures::globales().ajouterEcrits(erreur ? 0 : octets);
+            return true;
+        }
+        // Numbers padded with zeros to at least 3 digits (mat.b001.dist), or to the digits of R when it is larger
+        int chiffres = max(3, (int)to_string(options.nbReplicats).size());
+        for (int r = 0; r < options.nbReplicats; r++)
+        {
+            string numero = to_string(r + 1);
+            ecrireSortie(replicats[r], alignement, options, options.methode, prefixe, ".b" + string(chiffres - numero.size(), '0') + numero);
+            replicats[r] = MatriceCondensee();
+        }
+        return true;
+    }
+
+    // Streaming mode: rows of mat.dist are calculated and written by windows, without the matrice
+    if (options.flux && ((options.sortie == "-m") || (options.sortie == "--matrice")))
+    {
+        string nomFichier = prefixe + "mat.dist";
+        if (!moteur.ecrireFlux(alignement, options.methode, nomFichier))
+        {
+            return false;
+        }
+        cout << "Creation of " << nomFichier << " file (evolutionary distances matrice, PHYLIP format).\n";
+        error_code erreur;
+        uintmax_t octets = filesystem::file_size(nomFichier, erreur);
+        Mesures::globales().ajouterEcrits(erreur ? 0 : octets);
+        return true;
+    }
+
+    MatriceCondensee matriceDistancesEvolutives;
+    if (!options.fichierPrecedent.empty())
+    {
+        /*
+        Incremental mode: distances of the previous result are kept, only pairs with a new sequence are calculated.
+        */
+        MatricePrecedente precedente(options.fichierPrecedent.c_str());
+        if (!precedente.ouvert())
+        {
+            cerr << "Error: the previous result " << options.fichierPrecedent << " can't be read.\n";
+            return false;
+        }
+        // A PHYLIP file has neither the method nor the hash of the residues: it is used only if the user accepts it
+        if (!precedente.estBinaire())
+        {
+            if (!options.accepterPhylip)
+            {
+                cerr << "Error: the previous result " << options.fichierPrecedent << " is not a binary file (mat.bin): its method and the residues of its "
+                     << "sequences can't be checked (use --update-phylip to accept it).\n";
+                return false;
+            }
+            cerr << "Warning: PHYLIP previous result, the method and the residues of the sequences are not checked "
+                 << "(sequences are found by the first word of their header).\n";
+        }
+        if (precedente.estBinaire() && ((precedente.methode() != options.methode.nom) || (precedente.modele() != options.methode.modele)))
+        {
+            cerr << "Error: the previous result was calculated with another method (" << precedente.methode() << " " << precedente.modele() << ").\n";
+            return false;
+        }
+        cout << "Previous result: " << options.fichierPrecedent << ".\n";
+        matriceDistancesEvolutives = moteur.mettreAJour(alignement, precedente, options.methode);
+    }else{
+        // Distances estimation and evolutionary distances are calculated by blocks of rows directly into the matrice
+        matriceDistancesEvolutives = moteur.calculer(alignement, options.methode);
+    }
+    if (matriceDistancesEvolutives.nombreSequences() != tailleVecteur)
+    {
+        return false;
+    }
+    cout << "Creation of evolutionary distances matrice.\n";
+
+    cout << endl;
+
+    /*
+    Creation of the output file
+    */
+    ecrireSortie(matriceDistancesEvolutives, alignement, options, options.methode, prefixe, "");
+    return true;
+}
+
+// Function to get the name of a family from the path of its FASTA file (ex. "data/PF00001.fasta.gz" gives "PF00001")
+string nomFamille(const string& chemin)
+{
+    string nom = filesystem::path(chemin).filename().string();
+    for (const char* extension : {".gz", ".bgz"})
+    {
+        size_t longueur = strlen(extension);
+        if ((nom.size() > longueur) && (nom.compare(nom.size() - longueur, longueur, extension) == 0))
+        {
+            nom.erase(nom.size() - longueur);
+        }
+    }
+    size_t point = nom.rfind('.');
+    if ((point != string::npos) && (point > 0))
+    {
+        nom.erase(point);
+    }
+    return nom;
+}
+
+// Function to list the FASTA files of the batch mode: all the files of a directory, or one path per line of a manifest file
+vector<string> fichiersBatch(const string& source)
+{
+    vector<string> fichiers;
+    error_code erreur;
+    if (filesystem::is_directory(source, erreur))
+    {
+        for (const filesystem::directory_entry& entree : filesystem::directory_iterator(source, erreur))
+        {
+            string nom = entree.path().filename().string();
+            if (entree.is_regular_file(erreur) && (nom[0] != '.'))
+            {
+                fichiers.push_back(entree.path().string());
+            }
+        }
+        sort(fichiers.begin(), fichiers.end());
+        return fichiers;
+    }
+    // Manifest: empty lines and lines beginning with "#" are ignored
+    ifstream manifeste(source);
+    if (!manifeste.is_open())
+    {
+        cerr << "Error: the manifest or directory " << source << " can't be open.\n";
+        exit(-1);
+    }
+    string ligne;
+    while (getline(manifeste, ligne))
+    {
+        size_t debut = ligne.find_first_not_of(" \t\r");
+        size_t fin = ligne.find_last_not_of(" \t\r");
+        if ((debut != string::npos) && (ligne[debut] != '#'))
+        {
+            fichiers.push_back(ligne.substr(debut, fin - debut + 1));
+        }
+    }
+    return fichiers;
+}
 
-    Methode methode; // Object class Methode 
+int main(int argc, char** argv){
+    // Wall-clock and CPU time of the program (all threads)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Messages of the library (constructors, stages of the calculations) are written by the align client
+    activerJournal(true);
+
+    Fasta fichier; // Object class Fasta 
 
     struct alphaPC aPC; // Class Methode: Struct alphaPC
 
@@ -57,23 +418,18 @@ int main(int argc, char** argv){
 
     struct betaEI bEI; // Class Methode: Struct betaEI
 
-    string modele; // Variable for substitution models
-
-    string gaps; // Variable for ignoring gaps in all alignment columns
+    optionsAlign options; // Options of the command line
 
-    bool verifier, superieurTrois, taille; // Variable for boolean in functions: existe, superieurAtrois et tailleSequence 
+    bool batch = false; // Batch mode: the 2nd argument is a manifest file or a directory of aligned FASTA files
 
-    vector<fasta> vecFasta; // Variable to stock FASTA file informations in struct fasta vector
+    string dossierSortie = "."; // Directory of the output files in batch mode
 
-    int tailleVecteur, tailleDivergenceObservee; // Variable to stock the number of fasta vector elements and estimate distances vector length 
+    string fichierMesures; // JSON file of the performance measures (empty: not written)
 
-    fasta* tableauStruct; // Variable to stock 1D array informations of struct fasta 
+    bool compteursMateriels = false; // Hardware counters (cycles, cache misses) in the measures
 
-    vector<double> vecteurDivergenceObservee, vecteurDistancesEvolutives; // Variable to stock distance estimation and evolutionary distances 
+    bool progression = false; // Progress of the calculated pairs printed on cerr
 
-    double** matriceDistancesEvolutives; // Variable for distance matrice
-    
-    double alpha, beta; // Distance estimations parameters alpha and beta
     cout << endl;
 
     // Print Help manual if program arguments are inferior or equel to 3
@@ -81,141 +437,313 @@ int main(int argc, char** argv){
     if ((argc <= 3) || (strcmp(argv[1], "-h") == 0) || (strcmp(argv[1], "--help") == 0)) {
         fichier.usage(argc, argv);
         exit(0);
-    }else{
-        verifier = fichier.existe(2, argv); // Checking existence of the FASTA file
-        cout << "Checking existence of the FASTA file...\n";
-        // If FASTA file exists, then stock sequences and headers
-        if (verifier != 0){
-            cout << "The FASTA file exists.\n";
-
-            vecFasta = fichier.vecteurFasta(2, argv); // Struct fasta vector of FASTA file informations
-            cout << endl;
-            /*
-            Checking if the number of sequences in the FASTA file is strictly superior to 3
-            */
-            superieurTrois = fichier.superieurAtrois(vecFasta); 
-
-            cout << "The number of amino acids sequences is sufficient to construct distance matrice.\n";
-            tailleVecteur = fichier.tailleFasta(vecFasta); // Struct fasta vector length
-
-            cout << endl;
-    
-            taille = fichier.tailleSequence(vecFasta, tailleVecteur); // Checking if sequences are aligned 
-
-            cout << "Checking sequences alignement...\n";
-
-            if (taille != 0){
-                cout << "Amino acids sequences are aligned.\n";
-                cout << endl;
-
-                /*
-                User must choose to keep or not gaps in sequences alignement.
-                If the answer is yes, then alignment is recreated without gaps
-                */
-                cout << "Ignore gaps in all alignment columns?\n"
-                << "Y/n.\n";
-                cin >> gaps;
-                if ((gaps == "Y") || (gaps == "Yes") || (gaps == "y") || (gaps == "yes") || (gaps == "YES"))
-                {
-                    cout << "Remove gaps in the alignment.\n";
-                    vecFasta = fichier.ignoreAllGaps(vecFasta, tailleVecteur); // Remove gaps in the alignment and creation of the new one
-                    taille = fichier.tailleSequence(vecFasta, tailleVecteur); // Stock new length of sequences 
-                }else{
-                    cout << "Default: keeping gaps.\n"; // By default gaps are keep
-                }
-                cout << endl;
+    }
 
-                tableauStruct = fichier.tableauFasta(vecFasta, tailleVecteur); // Creation of an 1D array with struct fasta elements
+    options.sortie = argv[3];
+    // Other options after the output file option
+    for (int a = 4; a < argc; a++)
+    {
+        if (((strcmp(argv[a], "-t") == 0) || (strcmp(argv[a], "--threads") == 0)) && (a+1 < argc))
+        {
+            char* fin = nullptr;
+            errno = 0;
+            long threads = strtol(argv[++a], &fin, 10);
+            if ((fin == argv[a]) || (*fin != '\0') || (errno == ERANGE) || (threads < 0) || (threads > INT_MAX))
+            {
+                cerr << "Error: the number of threads must be an integer greater than or equal to 0 (0: all cores).\n";
+                exit(-1);
+            }
+            options.calcul.nbThreads = threads;
+        }else if (((strcmp(argv[a], "-e") == 0) || (strcmp(argv[a], "--engine") == 0)) && (a+1 < argc))
+        {
+            options.calcul.comptage = argv[++a];
+            if ((options.calcul.comptage != "byte") && (options.calcul.comptage != "bitsliced"))
+            {
+                cerr << "Error: unknown counting engine " << options.calcul.comptage << " (byte or bitsliced).\n";
+                exit(-1);
+            }
+        }else if (((strcmp(argv[a], "-D") == 0) || (strcmp(argv[a], "--disk") == 0)) && (a+1 < argc))
+        {
+            options.calcul.fichierMatrice = argv[++a];
+        }else if (((strcmp(argv[a], "-f") == 0) || (strcmp(argv[a], "--float") == 0)) && (a+1 < argc))
+        {
+            ++a;
+            if ((strcmp(argv[a], "32") != 0) && (strcmp(argv[a], "64") != 0))
+            {
+                cerr << "Error: unknown precision " << argv[a] << " of the binary distances (32 or 64).\n";
+                exit(-1);
+            }
+            options.precision = (strcmp(argv[a], "32") == 0) ? 4 : 8;
+        }else if (((strcmp(argv[a], "-M") == 0) || (strcmp(argv[a], "--methods") == 0)) && (a+1 < argc))
+        {
+            options.listeMethodes = argv[++a];
+        }else if (((strcmp(argv[a], "-c") == 0) || (strcmp(argv[a], "--cache") == 0)) && (a+1 < argc))
+        {
+            options.calcul.dossierCache = argv[++a];
+        }else if (((strcmp(argv[a], "-u") == 0) || (strcmp(argv[a], "--update") == 0)) && (a+1 < argc))
+        {
+            options.fichierPrecedent = argv[++a];
+        }else if (strcmp(argv[a], "--update-phylip") == 0)
+        {
+            options.accepterPhylip = true;
+        }else if (((strcmp(argv[a], "-S") == 0) || (strcmp(argv[a], "--model") == 0)) && (a+1 < argc))
+        {
+            options.methode.modele = argv[++a];
+        }else if (((strcmp(argv[a], "-O") == 0) || (strcmp(argv[a], "--outdir") == 0)) && (a+1 < argc))
+        {
+            dossierSortie = argv[++a];
+        }else if ((strcmp(argv[a], "-g") == 0) || (strcmp(argv[a], "--ignore-gaps") == 0))
+        {
+            options.calcul.sansGaps = true;
+        }else if (((strcmp(argv[a], "-G") == 0) || (strcmp(argv[a], "--max-gaps") == 0)) && (a+1 < argc))
+        {
+            char* fin = nullptr;
+            options.calcul.seuilColonnes = strtod(argv[++a], &fin);
+            if ((fin == argv[a]) || (*fin != '\0') || !(options.calcul.seuilColonnes >= 0.0) || (options.calcul.seuilColonnes > 100.0))
+            {
+                cerr << "Error: the maximum percentage of gaps and unknown amino acids must be a number between 0 and 100.\n";
+                exit(-1);
+            }
+        }else if ((strcmp(argv[a], "-W") == 0) || (strcmp(argv[a], "--patterns") == 0))
+        {
+            options.calcul.motifs = true;
+        }else if ((strcmp(argv[a], "-s") == 0) || (strcmp(argv[a], "--stream") == 0))
+        {
+            options.flux = true;
+        }else if ((strcmp(argv[a], "--bootstrap") == 0) && (a+1 < argc))
+        {
+            char* fin = nullptr;
+            errno = 0;
+            long replicats = strtol(argv[++a], &fin, 10);
+            if ((fin == argv[a]) || (*fin != '\0') || (errno == ERANGE) || (replicats < 1) || (replicats > INT_MAX))
+            {
+                cerr << "Error: the number of bootstrap replicates must be an integer greater than or equal to 1.\n";
+                exit(-1);
+            }
+            options.nbReplicats = replicats;
+        }else if ((strcmp(argv[a], "--seed") == 0) && (a+1 < argc))
+        {
+            char* fin = nullptr;
+            errno = 0;
+            options.graine = strtoull(argv[++a], &fin, 10);
+            // strtoull accepts a negative number (ex. "-1" gives 2^64-1): only digits are accepted
+            if ((fin == argv[a]) || (*fin != '\0') || (errno == ERANGE) || !isdigit((unsigned char)argv[a][0]))
+            {
+                cerr << "Error: the seed of the bootstrap must be an integer between 0 and 2^64-1.\n";
+                exit(-1);
+            }
+        }else if (strcmp(argv[a], "--concatenate") == 0)
+        {
+            options.concatener = true;
+        }else if ((strcmp(argv[a], "--max-distance") == 0) && (a+1 < argc))
+        {
+            char* fin = nullptr;
+            options.distanceMaximum = strtod(argv[++a], &fin);
+            if ((fin == argv[a]) || (*fin != '\0') || !(options.distanceMaximum >= 0.0))
+            {
+                cerr << "Error: the maximum distance must be a positive number.\n";
+                exit(-1);
+            }
+        }else if ((strcmp(argv[a], "-B") == 0) || (strcmp(argv[a], "--batch") == 0))
+        {
+            batch = true;
+        }else if ((strcmp(argv[a], "--metrics") == 0) && (a+1 < argc))
+        {
+            fichierMesures = argv[++a];
+        }else if (strcmp(argv[a], "--perf") == 0)
+        {
+            compteursMateriels = true;
+        }else if ((strcmp(argv[a], "-P") == 0) || (strcmp(argv[a], "--progress") == 0))
+        {
+            progression = true;
+        }else{
+            cerr << "Error: unknown option " << argv[a] << ".\n";
+            exit(-1);
+        }
+    }
 
-                cout << "Calculate distances estimation between sequences...\n";
-                vecteurDivergenceObservee = divergence.vecteurDivergences(vecFasta, tailleVecteur); // Creation of distances estimation vector
-                tailleDivergenceObservee = divergence.tailleDivergenceObservee(vecteurDivergenceObservee); // Stock distances estimation vector length
-                cout << "Distances estimation are calculate.\n";
+    // Choice of the evolutionary distances correction in function of the method (the substitution model is given by the option -S)
+    cout << "Checking evolutionary distances method...\n";
+    if (options.listeMethodes.empty())
+    {
+        if ((strcmp(argv[1], "-p") == 0) || (strcmp(argv[1], "--poisson") == 0))
+        {
+            options.methode.nom = "p"; // Poisson model for amino acids 
+            cout << "Method: Poisson model for amino acids.\n";
+        }else if ((strcmp(argv[1], "-k") == 0) || (strcmp(argv[1], "--kimura") == 0))
+        {
+            options.methode.nom = "k"; // Kimura estimation for PAM model
+            cout << "Method: Kimura estimation for PAM model..\n";
+        }else if ((strcmp(argv[1], "-jc") == 0) || (strcmp(argv[1], "--jukescantor") == 0))
+        {
+            options.methode.nom = "jc"; // Jukes-Cantor model for amino acids
+            cout << "Method: Jukes-Cantor model for amino acids..\n";
+        }else if ((strcmp(argv[1], "-pc") == 0) || (strcmp(argv[1], "--poissoncorrection") == 0)) // Estimation model: Poisson-Correction 
+        {
+            cout << "Estimation model: Poisson-Correction.\n";
+            options.methode.nom = "pc";
+            options.methode.alpha = aPC.setaPC(options.methode.modele); // Alpha variable for Poisson-Correction 
+            options.methode.beta = 1.00000; // Fixed Beta variable for Poisson-Correction
+            if (!aPC.modeleConnu)
+            {
+                cerr << "Error: unknown amino acids substitution model " << options.methode.modele << ".\n";
+                exit(-1);
+            }
+        }else if ((strcmp(argv[1], "-ei") == 0) || (strcmp(argv[1], "--equalinput") == 0)) // Estimation model: Equal-Input
+        {
+            cout << "Estimation model: Equal-Input.\n";
+            options.methode.nom = "ei";
+            options.methode.alpha = aEI.setaEI(options.methode.modele); // Alpha variable for Equal-Input 
+            options.methode.beta = bEI.setbEI(options.methode.modele); // Beta variable for Equal-Input 
+            if (!aEI.modeleConnu || !bEI.modeleConnu)
+            {
+                cerr << "Error: unknown amino acids substitution model " << options.methode.modele << ".\n";
+                exit(-1);
+            }
+        }else{
+            options.methode.nom = "d";
+            cout << "Default method: Distance estimation.\n"; // Default method: Distance estimation (no correction)
+        }
+        // The substitution model is written only for the estimation models (binary file)
+        if ((options.methode.nom != "pc") && (options.methode.nom != "ei"))
+        {
+            options.methode.modele.clear();
+        }
+    }
+    cout << endl;
 
-                cout << endl;
-                cout << "Checking evolutionary distances method...\n"; // Creation of evolutionary distances vector in function of the method
-                if ((strcmp(argv[1], "-p") == 0) || (strcmp(argv[1], "--poisson") == 0))
-                {
-                    vecteurDistancesEvolutives = methode.poisson(vecteurDivergenceObservee, tailleDivergenceObservee); // Poisson model for amino acids 
-                    cout << "Method: Poisson model for amino acids.\n";
-                }else if ((strcmp(argv[1], "-k") == 0) || (strcmp(argv[1], "--kimura") == 0))
-                {
-                   vecteurDistancesEvolutives = methode.kimura(vecteurDivergenceObservee, tailleDivergenceObservee); // Kimura estimation for PAM model
-                   cout << "Method: Kimura estimation for PAM model..\n";
-                }else if ((strcmp(argv[1], "-jc") == 0) || (strcmp(argv[1], "--jukescantor") == 0))
-                {
-                   vecteurDistancesEvolutives = methode.jukesCantor(vecteurDivergenceObservee, tailleDivergenceObservee); // Jukes-Cantor model for amino acids
-                   cout << "Method: Jukes-Cantor model for amino acids..\n";
-                }else if ((strcmp(argv[1], "-pc") == 0) || (strcmp(argv[1], "--poissoncorrection") == 0)) // Estimation model: Poisson-Correction 
-                {
-                    cout << "Estimation model: Poisson-Correction.\n";
-                    cout << "Please enter the amino acids substitution model: \n";
-                    cin >> modele; // User must enter manually the amino acids substitution model between 27 options available
-                    // Alpha variable for Poisson-Correction 
-                    alpha = aPC.setaPC(modele);
-                    beta = 1.00000; // Fixed Beta variable for Poisson-Correction
-                    vecteurDistancesEvolutives = methode.estimationGu(vecteurDivergenceObservee, tailleDivergenceObservee, alpha, beta); 
-                }else if ((strcmp(argv[1], "-ei") == 0) || (strcmp(argv[1], "--equalinput") == 0)) // Estimation model: Equal-Input
-                {
-                    cout << "Estimation model: Equal-Input.\n";
-                    cout << "Please enter the amino acids substitution model: \n";
-                    cin >> modele; // User must enter manually the amino acids substitution model between 27 options available
-                    alpha = aEI.setaEI(modele); // Alpha variable for Equal-Input 
-                    beta = bEI.setbEI(modele); // Beta variable for Equal-Input 
-                    vecteurDistancesEvolutives = methode.estimationGu(vecteurDivergenceObservee, tailleDivergenceObservee, alpha, beta);
-                }else{
-
-                    cout << "Default method: Distance estimation.\n";
-                    vecteurDistancesEvolutives = vecteurDivergenceObservee; // Default method: Distance estimation
-                }
-                
-                cout << endl;
+    if (!options.fichierPrecedent.empty() && (options.calcul.sansGaps || (options.calcul.seuilColonnes >= 0.0) || !options.listeMethodes.empty() || batch))
+    {
+        cerr << "Error: the incremental update can't be used with the removal of columns, several methods or the batch mode.\n";
+        exit(-1);
+    }
 
-                matriceDistancesEvolutives = methode.distance(vecteurDistancesEvolutives, tailleVecteur); // Creation of evolutionary distances matrice
-                cout << "Creation of evolutionary distances matrice.\n";
-                
-                /*
-                Creation of the output file
-                */
+    if ((options.nbReplicats > 0) && (!options.fichierPrecedent.empty() || !options.listeMethodes.empty() || options.flux))
+    {
+        cerr << "Error: the bootstrap can't be used with the incremental update, several methods or the streaming mode.\n";
+        exit(-1);
+    }
+    if ((options.distanceMaximum >= 0.0) && (!options.fichierPrecedent.empty() || !options.listeMethodes.empty() || options.flux
+        || (options.nbReplicats > 0)))
+    {
+        cerr << "Error: the sparse output can't be used with the incremental update, several methods, the streaming mode or the bootstrap.\n";
+        exit(-1);
+    }
+    if (options.concatener && ((options.nbReplicats <= 0) || ((options.sortie != "-m") && (options.sortie != "--matrice"))))
+    {
+        cerr << "Error: the concatenated file of the bootstrap replicates is written only in PHYLIP format (--bootstrap with -m).\n";
+        exit(-1);
+    }
 
-                if ((strcmp(argv[3], "-o") == 0) || (strcmp(argv[3], "--output") == 0))
-                {
-                    divergence.fichierDist(matriceDistancesEvolutives, vecteurDistancesEvolutives, vecFasta, tailleVecteur);
-                    cout << "Creation of seqs.dist file (evolutionary distances matrice informations).\n";
-                }else if ((strcmp(argv[3], "-m") == 0) || (strcmp(argv[3], "--matrice") == 0))
-                {
-                    divergence.fichierMat(matriceDistancesEvolutives, vecteurDistancesEvolutives, vecFasta, tailleVecteur);
-                    cout << "Creation of mat.dist file (evolutionary distances matrice, PHYLIP format).\n";
-                }
+    // Performance measures: hardware counters must be open before the threads are created
+    Mesures& mesures = Mesures::globales();
+    if (compteursMateriels)
+    {
+        mesures.activerCompteursMateriels();
+    }
+    if (progression)
+    {
+        mesures.demarrerProgression();
+    }
+    // Function to stop the progress and write the measures (also if the program stops with an error)
+    auto terminerMesures = [&]()
+    {
+        mesures.arreterProgression();
+        if (!fichierMesures.empty() && !mesures.ecrireJson(fichierMesures))
+        {
+            cerr << "Error: the measures can't be written in " << fichierMesures << ".\n";
+        }
+    };
+
+    if (!batch)
+    {
+        // One alignment: the output files are written in the current directory
+        if (!traiterAlignement(argv[2], options, ""))
+        {
+            terminerMesures();
+            exit(-1);
+        }
+    }else{
+        /*
+        Batch mode: each aligned FASTA file is one task of a shared pool of threads.
+        Files are sorted by decreasing size and distributed alternately on the threads: the largest alignments begin first
+        and the smallest ones fill the end of the run (work stealing). Each alignment is calculated on one thread
+        and its output files are written in dossierSortie with the name of the family as prefix (ex. PF00001.mat.dist)
+        */
+        vector<string> fichiers = fichiersBatch(argv[2]);
+        vector<pair<uintmax_t, string>> familles;
+        for (const string& chemin : fichiers)
+        {
+            error_code erreur;
+            uintmax_t tailleFichier = filesystem::file_size(chemin, erreur);
+            familles.push_back(make_pair(erreur ? 0 : tailleFichier, chemin));
+        }
+        stable_sort(familles.begin(), familles.end(), [](const pair<uintmax_t, string>& a, const pair<uintmax_t, string>& b) { return a.first > b.first; });
+
+        // Prefix of the output files: a family found several times is numbered
+        error_code erreur;
+        filesystem::create_directories(dossierSortie, erreur);
+        vector<string> noms, prefixes;
+        map<string, int> occurrences;
+        for (const pair<uintmax_t, string>& famille : familles)
+        {
+            string nom = nomFamille(famille.second);
+            int numero = occurrences[nom]++;
+            if (numero > 0)
+            {
+                nom += "_" + to_string(numero + 1);
+            }
+            noms.push_back(nom);
+            prefixes.push_back((filesystem::path(dossierSortie) / nom).string() + ".");
+        }
 
-                // Destruction of evolutionary distances matrice
-                
-                for (int i = 0; i < tailleVecteur-1; i++)
+        cout << "Batch mode: " << familles.size() << " aligned FASTA files, output files in " << dossierSortie << ".\n";
+        cout << endl;
+
+        // Messages of the alignments are mixed between threads: only the errors and the summary are printed
+        vector<char> reussites(familles.size(), 0);
+        cout.setstate(ios::badbit);
+        {
+            Parallele parallele(options.calcul.nbThreads);
+            parallele.executer(familles.size(), [&](size_t f)
+            {
+                optionsAlign optionsFamille = options;
+                // Matrices stocked on disk: one file per family
+                optionsFamille.calcul.nbThreads = 1;
+                if (!options.calcul.fichierMatrice.empty())
                 {
-                    delete[] matriceDistancesEvolutives[i];
-                }
-                delete[] matriceDistancesEvolutives;
-                
-                // Destruction stock 1D array struct fasta 
-                
-                delete [] tableauStruct;
-                }else{
-                    cerr << "Error: Amino acids sequences are not aligned.\n";
-                    exit(-1);
+                    optionsFamille.calcul.fichierMatrice = options.calcul.fichierMatrice + "." + noms[f];
                 }
-        }else{
-            cerr << "Error: the FASTA file can't be open.\n";
-            exit(-1); 
+                reussites[f] = traiterAlignement(familles[f].second.c_str(), optionsFamille, prefixes[f]);
+            }, true);
+        }
+        cout.clear();
+
+        int nbEchecs = 0;
+        for (size_t f = 0; f < familles.size(); f++)
+        {
+            if (!reussites[f])
+            {
+                cerr << "Error: no output files for " << familles[f].second << ".\n";
+                nbEchecs++;
+            }
+        }
+        cout << "Batch mode: " << familles.size() - nbEchecs << " alignments calculated, " << nbEchecs << " errors.\n";
+        if (nbEchecs > 0)
+        {
+            terminerMesures();
+            exit(-1);
         }
     }
-    end = clock(); // End of program
+    terminerMesures();
     cout << endl;
-    double time_taken = double(end - start) / double(CLOCKS_PER_SEC); // Calculate execution time 
+    // Calculate execution time: wall-clock time, and CPU time of all threads
+    double time_taken = chrono::duration<double>(chrono::steady_clock::now() - start).count();
     cout << "End of program.\n";
     cout << endl;
     cout << "Execution time: " << fixed
          << time_taken << setprecision(5); // Print execution time
-    cout << " secondes " << endl;
+    cout << " secondes (CPU: " << Mesures::tempsCPU() << " secondes, peak memory: " << Mesures::memoireMaximale() / 1048576 << " MB)" << endl;
     cout << endl;
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,291 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatriceCondensee: Evolutionary distances matrice stocked as its upper triangle in one block of n(n-1)/2 values.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "matrice.hpp"
+
+using namespace std;
+
+// MatriceCondensee Class constructor: matrice of n sequences initialised at 0
+MatriceCondensee::MatriceCondensee(int n)
+{
+    nbSequences = n;
+    nbValeurs = (n > 1) ? (size_t)n * (n - 1) / 2 : 0;
+    memoire.assign(nbValeurs, 0.0);
+    valeurs = memoire.data();
+    surDisque = false;
+}
+
+// MatriceCondensee Class constructor: matrice of n sequences with the distances vector (distances order)
+MatriceCondensee::MatriceCondensee(int n, vector<double>&& distances)
+{
+    nbSequences = n;
+    nbValeurs = (n > 1) ? (size_t)n * (n - 1) / 2 : 0;
+    // The distances vector becomes the upper triangle, without copy
+    memoire = std::move(distances);
+    memoire.resize(nbValeurs);
+    valeurs = memoire.data();
+    surDisque = false;
+}
+
+// MatriceCondensee Class constructor: matrice of n sequences stocked in the file chemin (mapped in memory)
+MatriceCondensee::MatriceCondensee(int n, const string& chemin)
+{
+    nbSequences = n;
+    nbValeurs = (n > 1) ? (size_t)n * (n - 1) / 2 : 0;
+    valeurs = NULL;
+    surDisque = true;
+
+    size_t tailleFichier = max(nbValeurs, (size_t)1) * sizeof(double);
+    int descripteur = open(chemin.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    // The file has the size of the matrice (sparse file: the disk is used only when distances are written)
+    if ((descripteur < 0) || (ftruncate(descripteur, tailleFichier) != 0))
+    {
+        if (descripteur >= 0)
+        {
+            close(descripteur);
+        }
+        cerr << "Error: the distance matrice file " << chemin << " can't be created.\n";
+        vider();
+        return;
+    }
+    void* projection = mmap(NULL, tailleFichier, PROT_READ | PROT_WRITE, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (projection == MAP_FAILED)
+    {
+        cerr << "Error: the distance matrice file " << chemin << " can't be mapped in memory.\n";
+        vider();
+        return;
+    }
+    valeurs = (double*)projection;
+}
+
+// Function to make the matrice empty (0 sequences, in memory) when its file can't be used
+void MatriceCondensee::vider()
+{
+    nbSequences = 0;
+    nbValeurs = 0;
+    surDisque = false;
+    memoire.clear();
+    valeurs = memoire.data();
+}
+
+// MatriceCondensee Class destructor: write and unmap the file
+MatriceCondensee::~MatriceCondensee()
+{
+    fermer();
+}
+
+// Function to release the mapped file
+void MatriceCondensee::fermer()
+{
+    if (surDisque && (valeurs != NULL))
+    {
+        size_t tailleFichier = max(nbValeurs, (size_t)1) * sizeof(double);
+        msync(valeurs, tailleFichier, MS_SYNC);
+        munmap(valeurs, tailleFichier);
+    }
+    valeurs = NULL;
+}
+
+// MatriceCondensee move constructor: the mapped file or the memory block is given to the new matrice
+MatriceCondensee::MatriceCondensee(MatriceCondensee&& autre)
+{
+    nbSequences = autre.nbSequences;
+    nbValeurs = autre.nbValeurs;
+    surDisque = autre.surDisque;
+    memoire = std::move(autre.memoire);
+    valeurs = surDisque ? autre.valeurs : memoire.data();
+    autre.valeurs = NULL;
+    autre.surDisque = false;
+    autre.nbValeurs = 0;
+}
+
+// MatriceCondensee move assignment: the mapped file or the memory block is given to this matrice
+MatriceCondensee& MatriceCondensee::operator=(MatriceCondensee&& autre)
+{
+    if (this != &autre)
+    {
+        fermer();
+        nbSequences = autre.nbSequences;
+        nbValeurs = autre.nbValeurs;
+        surDisque = autre.surDisque;
+        memoire = std::move(autre.memoire);
+        valeurs = surDisque ? autre.valeurs : memoire.data();
+        autre.valeurs = NULL;
+        autre.surDisque = false;
+        autre.nbValeurs = 0;
+    }
+    return *this;
+}
+
+// Function to write the distances [debut, fin) in the file and release them from memory (no effect in memory)
+void MatriceCondensee::liberer(size_t debut, size_t fin) const
+{
+    if (!surDisque || (fin <= debut))
+    {
+        return;
+    }
+    // Only the pages completely inside [debut, fin) are released: the pages at the borders are shared with the next blocks
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t premierOctet = ((debut * sizeof(double) + page - 1) / page) * page;
+    size_t dernierOctet = ((fin * sizeof(double)) / page) * page;
+    if (dernierOctet > premierOctet)
+    {
+        char* base = (char*)valeurs;
+        // Dirty pages are written to the file, then removed from the resident memory
+        msync(base + premierOctet, dernierOctet - premierOctet, MS_ASYNC);
+        madvise(base + premierOctet, dernierOctet - premierOctet, MADV_DONTNEED);
+    }
+}
+
+// Function to write octets bytes of donnees in the file descriptor at the position (return false if they can't be written)
+static bool ecrireFichier(int descripteur, const char* donnees, size_t octets, off_t position)
+{
+    while (octets > 0)
+    {
+        ssize_t ecrits = pwrite(descripteur, donnees, octets, position);
+        if (ecrits <= 0)
+        {
+            return false;
+        }
+        donnees += ecrits;
+        octets -= ecrits;
+        position += ecrits;
+    }
+    return true;
+}
+
+// Function to read octets bytes of the file descriptor at the position in donnees (return false if they can't be read)
+static bool lireFichier(int descripteur, char* donnees, size_t octets, off_t position)
+{
+    while (octets > 0)
+    {
+        ssize_t lus = pread(descripteur, donnees, octets, position);
+        if (lus <= 0)
+        {
+            return false;
+        }
+        donnees += lus;
+        octets -= lus;
+        position += lus;
+    }
+    return true;
+}
+
+// Function to write the bottom of the rows in the file chemin (row i: d(0,i),...,d(i-1,i) at the position i(i-1)/2)
+bool MatriceCondensee::ecrireColonnes(const string& chemin) const
+{
+    int descripteur = open(chemin.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descripteur < 0)
+    {
+        return false;
+    }
+    /*
+    Tile of the rows [k0, k1) and of the columns [c0, c1): each row of the tile is a contiguous part of a row of the triangle,
+    each column of the tile is a contiguous part of the bottom of a row (up to 16 KB read and written at once)
+    */
+    const int cote = 2048;
+    vector<double> tuile((size_t)cote * cote);
+    bool reussite = true;
+    for (int k0 = 0; (k0 < nbSequences - 1) && reussite; k0 += cote)
+    {
+        int k1 = min(nbSequences - 1, k0 + cote);
+        for (int c0 = k0 + 1; (c0 < nbSequences) && reussite; c0 += cote)
+        {
+            int c1 = min(nbSequences, c0 + cote);
+            // Columns of the tile stocked as rows: d(k, i) at the position (i - c0) x cote + (k - k0)
+            for (int k = k0; k < k1; k++)
+            {
+                int debut = max(c0, k + 1);
+                const double* ligneK = (debut < c1) ? valeurs + index(k, debut) : NULL;
+                for (int i = debut; i < c1; i++)
+                {
+                    tuile[(size_t)(i - c0) * cote + (k - k0)] = ligneK[i - debut];
+                }
+            }
+            for (int i = c0; (i < c1) && reussite; i++)
+            {
+                size_t nombre = min(k1, i) - k0;
+                reussite = ecrireFichier(descripteur, (const char*)(tuile.data() + (size_t)(i - c0) * cote), nombre * sizeof(double),
+                    ((size_t)i * (i - 1) / 2 + k0) * sizeof(double));
+            }
+        }
+        // Pages read for the rows of the tile are released (matrice stocked in a file)
+        liberer(index(k0, k0 + 1), index(k1 - 1, nbSequences - 1) + 1);
+    }
+    if (close(descripteur) != 0)
+    {
+        reussite = false;
+    }
+    return reussite;
+}
+
+// Function to copy the complete rows [premiere, derniere) of the symmetric matrice into lignes ((derniere-premiere) x n values)
+bool MatriceCondensee::lireLignes(int premiere, int derniere, double* lignes, int colonnes) const
+{
+    if (colonnes >= 0)
+    {
+        // Bottom of the rows from the file of the columns: the rows [premiere, derniere) are contiguous in the file
+        for (int i = premiere; i < derniere; i++)
+        {
+            if (!lireFichier(colonnes, (char*)(lignes + (size_t)(i - premiere) * nbSequences), (size_t)i * sizeof(double),
+                ((size_t)i * (i - 1) / 2) * sizeof(double)))
+            {
+                return false;
+            }
+        }
+    }else{
+        // Bottom of the rows: d(k, i) for k < i are the columns [premiere, derniere) of the previous rows k, contiguous in the row k
+        for (int k = 0; k < derniere; k++)
+        {
+            int debutColonnes = max(premiere, k + 1);
+            if (debutColonnes >= derniere)
+            {
+                continue;
+            }
+            const double* ligneK = valeurs + index(k, debutColonnes);
+            for (int i = debutColonnes; i < derniere; i++)
+            {
+                lignes[(size_t)(i - premiere) * nbSequences + k] = ligneK[i - debutColonnes];
+            }
+        }
+    }
+    // Diagonal and top of the rows: d(i, k) for k > i are contiguous in the row i
+    for (int i = premiere; i < derniere; i++)
+    {
+        double* ligne = lignes + (size_t)(i - premiere) * nbSequences;
+        ligne[i] = 0.0;
+        if (i + 1 < nbSequences)
+        {
+            memcpy(ligne + i + 1, valeurs + index(i, i + 1), (nbSequences - i - 1) * sizeof(double));
+        }
+    }
+    return true;
+}
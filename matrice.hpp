@@ -0,0 +1,119 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class MatriceCondensee: Evolutionary distances matrice stocked as its upper triangle in one block of n(n-1)/2 values.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#ifndef MATRICE_HPP
+#define MATRICE_HPP
+
+/*
+ Matrice triangulaire condensée: seules les distances d(i,j) avec i < j sont stockées, ligne par ligne.
+ Même ordre que le vecteur des distances: d(1,2),...,d(1,n), d(2,3),...,d(2,n),...
+ La diagonale vaut 0 et d(j,i) = d(i,j).
+ Pour un très grand nombre de séquences, la matrice peut être stockée dans un fichier projeté en mémoire (mmap):
+ les distances sont écrites par blocs de lignes et libérées de la mémoire une fois écrites
+*/
+class MatriceCondensee
+{
+  private:
+    int nbSequences; // Number of sequences
+
+    size_t nbValeurs; // Number of stocked distances: n(n-1)/2
+
+    double* valeurs; // Upper triangle of the matrice (in memoire or in the mapped file)
+
+    std::vector<double> memoire; // Upper triangle of the matrice if it is stocked in memory
+
+    bool surDisque; // True if the matrice is stocked in a mapped file
+
+    // Function to release the mapped file
+    void fermer();
+
+    // Function to make the matrice empty (0 sequences, in memory) when its file can't be used
+    void vider();
+
+  public:
+    // MatriceCondensee Class constructor: matrice of n sequences initialised at 0
+    MatriceCondensee(int n = 0);
+
+    // MatriceCondensee Class constructor: matrice of n sequences with the distances vector (distances order)
+    MatriceCondensee(int n, std::vector<double>&& distances);
+
+    // MatriceCondensee Class constructor: matrice of n sequences stocked in the file chemin (mapped in memory), empty matrice if the file can't be created
+    MatriceCondensee(int n, const std::string& chemin);
+
+    // MatriceCondensee Class destructor: write and unmap the file
+    ~MatriceCondensee();
+
+    // The matrice can be moved but not copied
+    MatriceCondensee(MatriceCondensee&& autre);
+    MatriceCondensee& operator=(MatriceCondensee&& autre);
+    MatriceCondensee(const MatriceCondensee&) = delete;
+    MatriceCondensee& operator=(const MatriceCondensee&) = delete;
+
+    // Function to stock the number of sequences
+    int nombreSequences() const { return nbSequences; };
+
+    // Function to stock the number of stocked distances: n(n-1)/2
+    size_t taille() const { return nbValeurs; };
+
+    // Function to check if the matrice is stocked in a mapped file
+    bool disque() const { return surDisque; };
+
+    // Function to get the position of d(i,j), i < j, in the upper triangle
+    size_t index(int i, int j) const
+    {
+      return (size_t)i * nbSequences - (size_t)i * (i + 1) / 2 + (j - i - 1);
+    };
+
+    // Function to get the distance between sequences i and j (0 on the diagonal)
+    double valeur(int i, int j) const
+    {
+      if (i == j)
+      {
+        return 0.0;
+      }
+      return (i < j) ? valeurs[index(i, j)] : valeurs[index(j, i)];
+    };
+
+    // Function to get the stocked distances (distances order)
+    double* donnees() { return valeurs; };
+    const double* donnees() const { return valeurs; };
+
+    // Function to write the distances [debut, fin) in the file and release them from memory (no effect in memory)
+    void liberer(size_t debut, size_t fin) const;
+
+    /*
+      Function to write the bottom of the rows in the file chemin (return false if it can't be written):
+        the row i of the file is d(0,i),...,d(i-1,i) (column i of the upper triangle), at the position i(i-1)/2
+        the upper triangle is read once, forward, by tiles of 2048 x 2048 distances (32 MB)
+    */
+    bool ecrireColonnes(const std::string& chemin) const;
+
+    /*
+      Function to copy the complete rows [premiere, derniere) of the symmetric matrice into lignes ((derniere-premiere) x n values):
+        colonnes: descriptor of the file written by ecrireColonnes (-1: the bottom of the rows is read in the upper triangle)
+    */
+    bool lireLignes(int premiere, int derniere, double* lignes, int colonnes = -1) const;
+};
+#endif
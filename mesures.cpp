@@ -0,0 +1,267 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Mesures: Performance measures of the program, wall-clock and CPU time of each stage, counters, peak memory, hardware counters and progress.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "mesures.hpp"
+
+using namespace std;
+
+Mesures::Mesures() : paires(0), sites(0), octetsLus(0), octetsEcrits(0), pairesPrevues(0)
+{
+    compteurs[0] = -1;
+    compteurs[1] = -1;
+    debut = chrono::steady_clock::now();
+    arret = false;
+}
+
+// Function to get the measures of the program
+Mesures& Mesures::globales()
+{
+    static Mesures mesures;
+    return mesures;
+}
+
+// Mesures Class destructor: stop the progress and close the hardware counters
+Mesures::~Mesures()
+{
+    arreterProgression();
+    for (int c = 0; c < 2; c++)
+    {
+        if (compteurs[c] >= 0)
+        {
+            close(compteurs[c]);
+        }
+    }
+}
+
+// Function to open the hardware counters (cycles, last level cache misses) of the process and its next threads
+bool Mesures::activerCompteursMateriels()
+{
+    const uint64_t configurations[2] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES};
+    for (int c = 0; c < 2; c++)
+    {
+        struct perf_event_attr attributs;
+        memset(&attributs, 0, sizeof(attributs));
+        attributs.type = PERF_TYPE_HARDWARE;
+        attributs.size = sizeof(attributs);
+        attributs.config = configurations[c];
+        attributs.exclude_kernel = 1;
+        attributs.exclude_hv = 1;
+        // The threads created after the opening are counted, their counts are added when they end
+        attributs.inherit = 1;
+        compteurs[c] = syscall(__NR_perf_event_open, &attributs, 0, -1, -1, 0);
+        if (compteurs[c] < 0)
+        {
+            // Not available (virtual machine, perf_event_paranoid): the program continues without hardware counters
+            cerr << "Warning: hardware counters are not available (" << strerror(errno) << ").\n";
+            if (c == 1)
+            {
+                close(compteurs[0]);
+                compteurs[0] = -1;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to read the hardware counters (0 if not available)
+void Mesures::lireCompteurs(uint64_t& cycles, uint64_t& defautsCache) const
+{
+    cycles = 0;
+    defautsCache = 0;
+    if (compteurs[0] >= 0)
+    {
+        if (read(compteurs[0], &cycles, sizeof(cycles)) != sizeof(cycles))
+        {
+            cycles = 0;
+        }
+        if (read(compteurs[1], &defautsCache, sizeof(defautsCache)) != sizeof(defautsCache))
+        {
+            defautsCache = 0;
+        }
+    }
+}
+
+// Function to add the measures of one execution of a stage
+void Mesures::ajouterEtape(const string& nom, double mur, double cpu, uint64_t cycles, uint64_t defautsCache)
+{
+    lock_guard<mutex> verrouEtapes(verrou);
+    size_t e = 0;
+    while ((e < etapes.size()) && (etapes[e].nom != nom))
+    {
+        e++;
+    }
+    if (e == etapes.size())
+    {
+        etapes.push_back(cumulEtape());
+        etapes[e].nom = nom;
+    }
+    etapes[e].mur += mur;
+    etapes[e].cpu += cpu;
+    etapes[e].cycles += cycles;
+    etapes[e].defautsCache += defautsCache;
+    etapes[e].nombre++;
+}
+
+// Function to print the progress on cerr every intervalle seconds: pairs calculated, pairs/s and estimated remaining time
+void Mesures::demarrerProgression(double intervalle)
+{
+    if (progression.joinable())
+    {
+        return;
+    }
+    arret = false;
+    progression = thread([this, intervalle]()
+    {
+        chrono::steady_clock::time_point depart = chrono::steady_clock::now();
+        uint64_t affichees = 0;
+        unique_lock<mutex> verrouAttente(verrouProgression);
+        while (!reveil.wait_for(verrouAttente, chrono::duration<double>(intervalle), [this]() { return arret; }))
+        {
+            uint64_t prevues = pairesPrevues;
+            uint64_t faites = paires;
+            // The rate is calculated from the first pairs to calculate, the line is printed only if pairs were calculated
+            if (prevues == 0)
+            {
+                depart = chrono::steady_clock::now();
+                continue;
+            }
+            if (faites == affichees)
+            {
+                continue;
+            }
+            affichees = faites;
+            double secondes = chrono::duration<double>(chrono::steady_clock::now() - depart).count();
+            double debit = faites / max(secondes, 1e-9);
+            double restant = (debit > 0) && (faites < prevues) ? (prevues - faites) / debit : 0.0;
+            cerr << "\rPairs: " << faites << "/" << prevues << " (" << fixed << setprecision(1) << 100.0 * faites / prevues << "%), "
+                 << setprecision(0) << debit << " pairs/s, ETA " << restant << " s    " << flush;
+        }
+        if (pairesPrevues > 0)
+        {
+            cerr << "\rPairs: " << paires << "/" << pairesPrevues << ", " << fixed << setprecision(1)
+                 << chrono::duration<double>(chrono::steady_clock::now() - depart).count() << " s" << string(24, ' ') << "\n";
+        }
+    });
+}
+
+// Function to stop the progress (last line printed)
+void Mesures::arreterProgression()
+{
+    if (!progression.joinable())
+    {
+        return;
+    }
+    {
+        lock_guard<mutex> verrouAttente(verrouProgression);
+        arret = true;
+    }
+    reveil.notify_all();
+    progression.join();
+}
+
+// Function to get the CPU time of the process (all threads, s)
+double Mesures::tempsCPU()
+{
+    struct timespec temps;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &temps);
+    return temps.tv_sec + temps.tv_nsec * 1e-9;
+}
+
+// Function to get the peak resident memory of the process (bytes)
+uint64_t Mesures::memoireMaximale()
+{
+    struct rusage utilisation;
+    getrusage(RUSAGE_SELF, &utilisation);
+    return (uint64_t)utilisation.ru_maxrss * 1024; // ru_maxrss in kilobytes on Linux
+}
+
+// Function to write all measures in a JSON file
+bool Mesures::ecrireJson(const string& chemin) const
+{
+    ofstream fichier(chemin);
+    if (!fichier.is_open())
+    {
+        return false;
+    }
+    double total = chrono::duration<double>(chrono::steady_clock::now() - debut).count();
+    fichier << setprecision(9);
+    fichier << "{\n"
+            << "  \"wall_seconds\": " << total << ",\n"
+            << "  \"cpu_seconds\": " << tempsCPU() << ",\n"
+            << "  \"peak_rss_bytes\": " << memoireMaximale() << ",\n"
+            << "  \"counters\": {\"pairs\": " << paires << ", \"sites\": " << sites << ", \"bytes_read\": " << octetsLus
+            << ", \"bytes_written\": " << octetsEcrits << "},\n"
+            << "  \"hardware_counters\": " << (compteursMateriels() ? "true" : "false") << ",\n"
+            << "  \"stages\": [\n";
+    lock_guard<mutex> verrouEtapes(verrou);
+    for (size_t e = 0; e < etapes.size(); e++)
+    {
+        const cumulEtape& etape = etapes[e];
+        fichier << "    {\"stage\": \"" << etape.nom << "\", \"count\": " << etape.nombre << ", \"wall_seconds\": " << etape.mur
+                << ", \"cpu_seconds\": " << etape.cpu;
+        if (compteursMateriels())
+        {
+            fichier << ", \"cycles\": " << etape.cycles << ", \"llc_misses\": " << etape.defautsCache;
+        }
+        fichier << "}" << ((e + 1 < etapes.size()) ? ",\n" : "\n");
+    }
+    fichier << "  ]\n}\n";
+    fichier.close();
+    return !fichier.fail();
+}
+
+// chronoEtape Class constructor: the stage begins
+chronoEtape::chronoEtape(const string& etape)
+{
+    nom = etape;
+    Mesures::globales().lireCompteurs(debutCycles, debutDefauts);
+    debutCPU = Mesures::tempsCPU();
+    debutMur = chrono::steady_clock::now();
+}
+
+// chronoEtape Class destructor: the stage ends
+chronoEtape::~chronoEtape()
+{
+    double mur = chrono::duration<double>(chrono::steady_clock::now() - debutMur).count();
+    double cpu = Mesures::tempsCPU() - debutCPU;
+    uint64_t cycles, defauts;
+    Mesures::globales().lireCompteurs(cycles, defauts);
+    Mesures::globales().ajouterEtape(nom, mur, cpu, cycles - debutCycles, defauts - debutDefauts);
+}
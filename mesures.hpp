@@ -0,0 +1,151 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Mesures: Performance measures of the program, wall-clock and CPU time of each stage, counters, peak memory, hardware counters and progress.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdint.h>
+
+#ifndef MESURES_HPP
+#define MESURES_HPP
+
+/*
+ Mesures de performance du programme (un seul objet, Mesures::globales()):
+   Temps réel et temps CPU du processus de chaque étape (cumulés si une étape est exécutée plusieurs fois, ex. mode batch)
+   Compteurs: paires calculées, sites comparés, octets lus et écrits
+   Mémoire résidente maximale (getrusage)
+   Compteurs matériels optionnels (perf_event_open): cycles et défauts du dernier niveau de cache, threads inclus
+   Progression périodique sur cerr: paires calculées, paires/s et temps restant
+*/
+class Mesures
+{
+  private:
+    // Cumulated measures of one stage
+    struct cumulEtape
+    {
+      std::string nom; // Name of the stage
+      double mur = 0.0; // Wall-clock time (s)
+      double cpu = 0.0; // CPU time of the process (s)
+      uint64_t cycles = 0; // CPU cycles (hardware counter)
+      uint64_t defautsCache = 0; // Last level cache misses (hardware counter)
+      int nombre = 0; // Number of executions of the stage
+    };
+
+    mutable std::mutex verrou; // Lock of the stages
+
+    std::vector<cumulEtape> etapes; // Stages in order of their first execution
+
+    std::atomic<uint64_t> paires; // Pairs of sequences calculated
+
+    std::atomic<uint64_t> sites; // Sites of the alignment compared (pairs x columns)
+
+    std::atomic<uint64_t> octetsLus; // Bytes of the input files
+
+    std::atomic<uint64_t> octetsEcrits; // Bytes of the output files
+
+    std::atomic<uint64_t> pairesPrevues; // Pairs to calculate (progress)
+
+    int compteurs[2]; // File descriptors of the hardware counters (-1: not available)
+
+    std::chrono::steady_clock::time_point debut; // Beginning of the program
+
+    std::thread progression; // Thread printing the progress
+
+    std::mutex verrouProgression; // Lock of the progress thread
+
+    std::condition_variable reveil; // Stop of the progress thread
+
+    bool arret; // True if the progress thread must stop
+
+    Mesures();
+
+  public:
+    // Function to get the measures of the program
+    static Mesures& globales();
+
+    // Mesures Class destructor: stop the progress and close the hardware counters
+    ~Mesures();
+
+    Mesures(const Mesures&) = delete;
+    Mesures& operator=(const Mesures&) = delete;
+
+    // Function to open the hardware counters (cycles, last level cache misses) of the process and its next threads
+    bool activerCompteursMateriels();
+
+    // Function to check if the hardware counters are open
+    bool compteursMateriels() const { return compteurs[0] >= 0; };
+
+    // Function to read the hardware counters (0 if not available)
+    void lireCompteurs(uint64_t& cycles, uint64_t& defautsCache) const;
+
+    // Function to add the measures of one execution of a stage
+    void ajouterEtape(const std::string& nom, double mur, double cpu, uint64_t cycles, uint64_t defautsCache);
+
+    // Functions to add to the counters
+    void prevoirPaires(uint64_t nombre) { pairesPrevues += nombre; };
+    void ajouterPaires(uint64_t nombre, uint64_t sitesCompares) { paires += nombre; sites += sitesCompares; };
+    void ajouterLus(uint64_t octets) { octetsLus += octets; };
+    void ajouterEcrits(uint64_t octets) { octetsEcrits += octets; };
+
+    // Function to print the progress on cerr every intervalle seconds: pairs calculated, pairs/s and estimated remaining time
+    void demarrerProgression(double intervalle = 1.0);
+
+    // Function to stop the progress (last line printed)
+    void arreterProgression();
+
+    // Function to get the CPU time of the process (all threads, s)
+    static double tempsCPU();
+
+    // Function to get the peak resident memory of the process (bytes)
+    static uint64_t memoireMaximale();
+
+    // Function to write all measures in a JSON file
+    bool ecrireJson(const std::string& chemin) const;
+};
+
+/*
+ Chronomètre d'une étape: les mesures sont ajoutées à Mesures::globales() à la destruction
+*/
+class chronoEtape
+{
+  private:
+    std::string nom; // Name of the stage
+
+    std::chrono::steady_clock::time_point debutMur; // Wall-clock time at the beginning
+
+    double debutCPU; // CPU time at the beginning
+
+    uint64_t debutCycles, debutDefauts; // Hardware counters at the beginning
+
+  public:
+    // chronoEtape Class constructor: the stage begins
+    chronoEtape(const std::string& etape);
+
+    // chronoEtape Class destructor: the stage ends
+    ~chronoEtape();
+};
+#endif
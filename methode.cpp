@@ -27,83 +27,186 @@
 #include <math.h> 
 
 #include "methode.hpp"
+#include "parallele.hpp"
 
 using namespace std;
 
 // Function to calculate evolutinary distances with Poisson model for amino acids (options "-p" or "--poisson")
 vector<double> Methode::poisson(vector<double> divergenceObservee, int tailleDivergence)
 {
-    // Vector to stock evolutinary distances
-    vector<double> p;
+    // The vector of distances estimation is transformed in place (no copy of the distances)
+    poisson(divergenceObservee.data(), tailleDivergence);
+    return divergenceObservee;
+}
 
-    // Evolutinary distances variable
-    double distance = 0;
+// Function to calculate evolutinary distances with Kimura estimation for PAM model (options "-k" or "--kimura")
+vector<double> Methode::kimura(vector<double> divergenceObservee, int tailleDivergence)
+{
+    kimura(divergenceObservee.data(), tailleDivergence);
+    return divergenceObservee;
+}
 
-    for (int i = 0; i < tailleDivergence; i++) 
+// Function to calculate evolutinary distances with Jukes-Cantor model for amino acids (options "-jc" or "--jukescantor")
+vector<double> Methode::jukesCantor(vector<double> divergenceObservee, int tailleDivergence)
+{
+    jukesCantor(divergenceObservee.data(), tailleDivergence);
+    return divergenceObservee;
+}
+
+// Function to calculate evolutinary distances with estimation models (Poisson Correction or Equal-Input) (options "-pc" or "--poissoncorection" / "-ei" or "--equal-input")
+vector<double> Methode::estimationGu(vector<double> divergenceObservee, int tailleDivergence, double alpha, double beta)
+{
+    estimationGu(divergenceObservee.data(), tailleDivergence, alpha, beta);
+    return divergenceObservee;
+}
+
+// Function to calculate evolutinary distances in place with Poisson model for amino acids
+void Methode::poisson(double* distances, size_t taille)
+{
+    for (size_t i = 0; i < taille; i++)
     {
         // t = -ln(1-p)
-        distance = -log(1.0-divergenceObservee[i]);
-        p.push_back(distance);
-        distance = 0;
+        distances[i] = correctionPoisson()(distances[i]);
     }
-    return p;
 }
 
-// Function to calculate evolutinary distances with Kimura estimation for PAM model (options "-k" or "--kimura")
-vector<double> Methode::kimura(vector<double> divergenceObservee, int tailleDivergence)
+// Function to calculate evolutinary distances in place with Kimura estimation for PAM model
+void Methode::kimura(double* distances, size_t taille)
 {
-    // Vector to stock evolutinary distances
-    vector<double> k;
-
-    // Evolutinary distances variable
-    double distance = 0;
-
-    for (int i = 0; i < tailleDivergence; i++) 
+    for (size_t i = 0; i < taille; i++)
     {
         // t = -ln(1-p-0.2*p²)
-        distance = -log(1.0-divergenceObservee[i]-0.2*(pow(divergenceObservee[i],2.0)));
-        k.push_back(distance);
-        distance = 0;
+        distances[i] = correctionKimura()(distances[i]);
     }
-    return k;
 }
 
-// Function to calculate evolutinary distances with Jukes-Cantor model for amino acids (options "-jc" or "--jukescantor")
-vector<double> Methode::jukesCantor(vector<double> divergenceObservee, int tailleDivergence)
+// Function to calculate evolutinary distances in place with Jukes-Cantor model for amino acids
+void Methode::jukesCantor(double* distances, size_t taille)
 {
-     // Vector to stock evolutinary distances
-    vector<double> jc;
-
-    // Evolutinary distances variable
-    double distance = 0;
-
-    for (int i = 0; i < tailleDivergence; i++) 
+    for (size_t i = 0; i < taille; i++)
     {
         // t = -19/20*n(1-20/19*p)
-        distance = -19.0/20.0*log(1.0-20.0/19.0*divergenceObservee[i]);
-        jc.push_back(distance);
-        distance = 0;
+        distances[i] = correctionJukesCantor()(distances[i]);
     }
-    return jc;
 }
 
-// Function to calculate evolutinary distances with estimation models (Poisson Correction or Equal-Input) (options "-pc" or "--poissoncorection" / "-ei" or "--equal-input")
-vector<double> Methode::estimationGu(vector<double> divergenceObservee, int tailleDivergence, double alpha, double beta)
+// Function to calculate evolutinary distances in place with estimation models (Poisson Correction or Equal-Input)
+void Methode::estimationGu(double* distances, size_t taille, double alpha, double beta)
+{
+    correctionGu correction{alpha, beta};
+    for (size_t i = 0; i < taille; i++)
+    {
+        // t = a*b*((1-p/b)^-1a - 1)
+        distances[i] = correction(distances[i]);
+    }
+}
+
+// Function to read a list of methods separated by commas (ex. "d,p,k,jc,pc:LG,ei:WAG") with their models
+vector<descripteurMethode> Methode::descripteurs(const string& liste)
 {
-    // Vector to stock evolutinary distances
-    vector<double> gu;
+    vector<descripteurMethode> methodes;
+    size_t debut = 0;
+    while (debut <= liste.size())
+    {
+        size_t fin = liste.find(',', debut);
+        if (fin == string::npos)
+        {
+            fin = liste.size();
+        }
+        string element = liste.substr(debut, fin - debut);
+        debut = fin + 1;
+        if (element.empty())
+        {
+            continue;
+        }
+
+        // Method and substitution model separated by ":"
+        descripteurMethode methode;
+        size_t separateur = element.find(':');
+        methode.nom = element.substr(0, separateur);
+        methode.modele = (separateur == string::npos) ? "" : element.substr(separateur + 1);
+        methode.alpha = 1.0;
+        methode.beta = 1.0;
+        bool modeleConnu = true;
+        if (methode.nom == "pc")
+        {
+            alphaPC aPC;
+            methode.alpha = aPC.setaPC(methode.modele);
+            modeleConnu = aPC.modeleConnu;
+        }else if (methode.nom == "ei")
+        {
+            alphaEI aEI;
+            betaEI bEI;
+            methode.alpha = aEI.setaEI(methode.modele);
+            methode.beta = bEI.setbEI(methode.modele);
+            modeleConnu = aEI.modeleConnu && bEI.modeleConnu;
+        }else if ((methode.nom != "d") && (methode.nom != "p") && (methode.nom != "k") && (methode.nom != "jc"))
+        {
+            cerr << "Error: unknown evolutionary distances method " << methode.nom << ".\n";
+            return vector<descripteurMethode>();
+        }else{
+            methode.modele.clear();
+        }
+        // The model is written in the names of the output files and in mat.bin: an unknown model is not replaced by Dayhoff
+        if (!modeleConnu)
+        {
+            cerr << "Error: unknown amino acids substitution model " << methode.modele << ".\n";
+            return vector<descripteurMethode>();
+        }
+        methodes.push_back(methode);
+    }
+    if (methodes.empty())
+    {
+        cerr << "Error: no evolutionary distances method in the list \"" << liste << "\".\n";
+    }
+    return methodes;
+}
 
-    // Evolutinary distances variable
-    double distance = 0;
+// Function to calculate evolutinary distances of a method in place on a block of distances estimation
+void Methode::corriger(const descripteurMethode& methode, double* distances, size_t taille)
+{
+    // Loop instantiated for the correction of the method (method "d": distances estimation are kept)
+    selonCorrection(methode, [&](auto correction)
+    {
+        for (size_t i = 0; i < taille; i++)
+        {
+            distances[i] = correction(distances[i]);
+        }
+    });
+}
 
-    // Alpha and Beta variables
-    double a, b;
-    for (int i = 0; i < tailleDivergence; i++) 
+// Function to get the name of a method for the output files (ex. "pc-LG")
+string Methode::suffixe(const descripteurMethode& methode)
+{
+    string nom = methode.nom;
+    if (!methode.modele.empty())
     {
-        // t = a*b*((1-p/b)^-1a - 1)
-        distance = alpha*beta*(pow(1-divergenceObservee[i]/beta, -1/alpha)-1);
-        gu.push_back(distance);
-        distance = 0;
+        nom += "-" + methode.modele;
+    }
+    // Only letters, digits, "-" and "_" in the file names (ex. "WAG*" becomes "WAG_")
+    for (char& c : nom)
+    {
+        if (!isalnum((unsigned char)c) && (c != '-') && (c != '_'))
+        {
+            c = '_';
+        }
     }
-    return gu;
-}
\ No newline at end of file
+    return nom;
+}
+
+// Function to copy the distances estimation matrice into distances and calculate the evolutinary distances of a method (nbThreads threads)
+void Methode::appliquer(const descripteurMethode& methode, const MatriceCondensee& divergences, MatriceCondensee& distances, int nbThreads)
+{
+    // Blocks of 64K distances
+    const size_t TAILLE_BLOC = (size_t)1 << 16;
+    size_t nbBlocs = (divergences.taille() + TAILLE_BLOC - 1) / TAILLE_BLOC;
+    Parallele parallele(nbThreads);
+    parallele.executer(nbBlocs, [&](size_t bloc)
+    {
+        size_t debut = bloc * TAILLE_BLOC;
+        size_t fin = min(divergences.taille(), debut + TAILLE_BLOC);
+        copy(divergences.donnees() + debut, divergences.donnees() + fin, distances.donnees() + debut);
+        corriger(methode, distances.donnees() + debut, fin - debut);
+        distances.liberer(debut, fin);
+    });
+}
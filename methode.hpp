@@ -28,6 +28,7 @@
 
 
 #include "divergence.hpp" // divergence.hpp inclusion to use it's functions (inheritance)
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
 
 #ifndef METHODE_HPP
 #define METHODE_HPP
@@ -65,6 +66,7 @@ struct alphaPC
     double WAGstar = 2.80430;
   public :
     std::string modeleSubstitution;
+    bool modeleConnu = true; // False if the model is not one of the 27 models (the default model Dayhoff is used)
 
     // Function to give the value for the "a" parameter of Poisson-Correction method.
     double setaPC(std::string modeleSubstitution)
@@ -79,9 +81,9 @@ struct alphaPC
         aPC = cpREV64;
       }else if ((modeleSubstitution == "CPREV") || (modeleSubstitution == "cprev") || (modeleSubstitution == "cpREV")){
         aPC = cpREV;
-      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF")){
+      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF") || (modeleSubstitution == "DCMut-Dayhoff")){
         aPC = DCMutDayhoff;
-      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT")){
+      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT") || (modeleSubstitution == "DCMut-JTT")){
         aPC = DCMutJTT;
       }else if ((modeleSubstitution == "DEN") || (modeleSubstitution == "Den") || (modeleSubstitution == "den")){
         aPC = DEN;
@@ -124,12 +126,14 @@ struct alphaPC
       }else if ((modeleSubstitution == "WAG*") || (modeleSubstitution == "Wag*") || (modeleSubstitution == "WAGSTAR") || (modeleSubstitution == "wag*")  || (modeleSubstitution == "Wagstar") || (modeleSubstitution == "wagstar")){
         aPC = WAGstar;        
       }else{
-          std::cout << "Default model for alpha parameter: Dayhoff.\n";
+          // Unknown model: refused by the callers (the empty model and Dayhoff are the default model)
+          modeleConnu = modeleSubstitution.empty() || (modeleSubstitution == "Dayhoff") || (modeleSubstitution == "dayhoff") || (modeleSubstitution == "DAYHOFF");
+          journal() << "Default model for alpha parameter: Dayhoff.\n";
           // By default "a" parameter get value of the Dayhoff model
           aPC = 1.99924;
       }
-      std::cout << "Alpha for Poisson Correction method: " << aPC << std::endl;
-      std::cout << "Beta for Poisson Correction method: " << std::fixed << std::setprecision(5) << 1.00000 << std::endl;
+      journal() << "Alpha for Poisson Correction method: " << aPC << std::endl;
+      journal() << "Beta for Poisson Correction method: " << std::fixed << std::setprecision(5) << 1.00000 << std::endl;
       return aPC;
     }
 };
@@ -167,6 +171,7 @@ struct alphaEI
     const double WAGstarAlpha = 5.01598;
     public :
     std::string modeleSubstitution;
+    bool modeleConnu = true; // False if the model is not one of the 27 models (the default model Dayhoff is used)
 
     // Function to give the value for the "a" parameter of Equal-Input method.
     double setaEI(std::string modeleSubstitution)
@@ -181,9 +186,9 @@ struct alphaEI
         aEI = cpREV64alpha;
       }else if ((modeleSubstitution == "CPREV") || (modeleSubstitution == "cprev") || (modeleSubstitution == "cpREV")){
         aEI = cpREValpha;
-      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF")){
+      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF") || (modeleSubstitution == "DCMut-Dayhoff")){
         aEI = DCMutDayhoffAlpha;
-      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT")){
+      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT") || (modeleSubstitution == "DCMut-JTT")){
         aEI = DCMutJTTalpha;
       }else if ((modeleSubstitution == "DEN") || (modeleSubstitution == "Den") || (modeleSubstitution == "den")){
         aEI = DENalpha;
@@ -226,11 +231,13 @@ struct alphaEI
       }else if ((modeleSubstitution == "WAG*") || (modeleSubstitution == "Wag*") || (modeleSubstitution == "WAGSTAR") || (modeleSubstitution == "wag*")  || (modeleSubstitution == "Wagstar") || (modeleSubstitution == "wagstar")){
         aEI = WAGstarAlpha;        
       }else{
-        std::cout << "Default model for alpha parameter: Dayhoff.\n";
+        // Unknown model: refused by the callers (the empty model and Dayhoff are the default model)
+        modeleConnu = modeleSubstitution.empty() || (modeleSubstitution == "Dayhoff") || (modeleSubstitution == "dayhoff") || (modeleSubstitution == "DAYHOFF");
+        journal() << "Default model for alpha parameter: Dayhoff.\n";
         // By default "a" parameter get value of the Dayhoff model
         aEI = 3.14582;
       }
-    std::cout << "Alpha for Equal-input method: " << aEI << std::endl;
+    journal() << "Alpha for Equal-input method: " << aEI << std::endl;
     return aEI;
   }
 };
@@ -267,6 +274,8 @@ struct betaEI
     const double WAGbeta = 0.94055;
     const double WAGstarBeta = 0.94055;
   public:
+  bool modeleConnu = true; // False if the model is not one of the 27 models (the default model Dayhoff is used)
+
   // Function to give the value for the "b" parameter of Equal-Input model.
    double setbEI(std::string modeleSubstitution)
     {
@@ -280,9 +289,9 @@ struct betaEI
         bEI = cpREV64beta;
       }else if ((modeleSubstitution == "CPREV") || (modeleSubstitution == "cprev") || (modeleSubstitution == "cpREV")){
         bEI = cpREVbeta;
-      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF")){
+      }else if ((modeleSubstitution == "DCMutDayhoff") || (modeleSubstitution == "Dcmutdayhoff") || (modeleSubstitution == "DcmutDayhoff") || (modeleSubstitution == "dcmutDayhoff") || (modeleSubstitution == "dcmutdayhoff") || (modeleSubstitution == "DCMUTDAYHOFF") || (modeleSubstitution == "DCMut-Dayhoff")){
         bEI = DCMutDayhoffBeta;
-      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT")){
+      }else if ((modeleSubstitution == "DCMutJTT") || (modeleSubstitution == "Dcmutjtt") || (modeleSubstitution == "DcmutJtt") || (modeleSubstitution == "dcmutJtt") || (modeleSubstitution == "dcmutjtt") || (modeleSubstitution == "DCMUTJTT") || (modeleSubstitution == "DCMut-JTT")){
         bEI = DCMutJTTbeta;
       }else if ((modeleSubstitution == "DEN") || (modeleSubstitution == "Den") || (modeleSubstitution == "den")){
         bEI = DENbeta;
@@ -325,11 +334,13 @@ struct betaEI
       }else if ((modeleSubstitution == "WAG*") || (modeleSubstitution == "Wag*") || (modeleSubstitution == "WAGSTAR") || (modeleSubstitution == "wag*")  || (modeleSubstitution == "Wagstar") || (modeleSubstitution == "wagstar")){
         bEI = WAGstarBeta;        
       }else{
-          std::cout << "Default model for beta parameter: Dayhoff.\n";
+          // Unknown model: refused by the callers (the empty model and Dayhoff are the default model)
+          modeleConnu = modeleSubstitution.empty() || (modeleSubstitution == "Dayhoff") || (modeleSubstitution == "dayhoff") || (modeleSubstitution == "DAYHOFF");
+          journal() << "Default model for beta parameter: Dayhoff.\n";
           // Par défaut le paramètre b du modèle de Dayhoff
           bEI = 0.93993;
       }
-      std::cout << "Beta for Equal-input method: " << bEI << std::endl;
+      journal() << "Beta for Equal-input method: " << bEI << std::endl;
       return bEI;
     }
 };
@@ -345,13 +356,13 @@ class Methode : public Divergence
     // Methode Class constructor
     Methode()
     {
-      std::cout << "Methode Class constructor.\n";
+      journal() << "Methode Class constructor.\n";
     };
 
     // Methode Class destructor
     ~Methode()
     {
-      std::cout << "Methode Class destructor.\n";
+      journal() << "Methode Class destructor.\n";
     };
 
     // Function to calculate evolutinary distances with Poisson model for amino acids (options "-p" or "--poisson")
@@ -365,5 +376,23 @@ class Methode : public Divergence
 
     // Function to calculate evolutinary distances with estimation models (Poisson Correction or Equal-Input) (options "-pc" or "--poissoncorection" / "-ei" or "--equal-input")
     std::vector<double> estimationGu(std::vector<double> divergenceObservee, int tailleDivergence, double alpha, double beta);
+
+    // Functions to calculate evolutinary distances in place on a block of distances estimation (block of the condensed matrice)
+    void poisson(double* distances, size_t taille);
+    void kimura(double* distances, size_t taille);
+    void jukesCantor(double* distances, size_t taille);
+    void estimationGu(double* distances, size_t taille, double alpha, double beta);
+
+    // Function to read a list of methods separated by commas (ex. "d,p,k,jc,pc:LG,ei:WAG") with their models (unknown method or model: error on cerr and empty list)
+    std::vector<descripteurMethode> descripteurs(const std::string& liste);
+
+    // Function to calculate evolutinary distances of a method in place on a block of distances estimation
+    void corriger(const descripteurMethode& methode, double* distances, size_t taille);
+
+    // Function to get the name of a method for the output files (ex. "pc-LG")
+    static std::string suffixe(const descripteurMethode& methode);
+
+    // Function to copy the distances estimation matrice into distances and calculate the evolutinary distances of a method (nbThreads threads)
+    void appliquer(const descripteurMethode& methode, const MatriceCondensee& divergences, MatriceCondensee& distances, int nbThreads = 1);
 };
 #endif
\ No newline at end of file
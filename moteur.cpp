@@ -0,0 +1,339 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class DistanceEngine: Library interface of Align, distance matrice of sequences in memory or of an encoded alignment, without files.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+
+#include "moteur.hpp"
+#include "journal.hpp"
+
+using namespace std;
+
+// DistanceEngine Class constructor
+DistanceEngine::DistanceEngine(const optionsMoteur& optionsCalcul)
+{
+    options = optionsCalcul;
+    journal() << "DistanceEngine Class constructor.\n";
+}
+
+// DistanceEngine Class destructor
+DistanceEngine::~DistanceEngine()
+{
+    journal() << "DistanceEngine Class destructor.\n";
+}
+
+// Function to get the descriptor of a method (ex. "p", or "pc" and "LG"): alpha and beta of the substitution model
+descripteurMethode DistanceEngine::descripteur(const string& nom, const string& modele)
+{
+    Methode methodes;
+    vector<descripteurMethode> liste = methodes.descripteurs(modele.empty() ? nom : nom + ":" + modele);
+    if (liste.size() != 1)
+    {
+        // Unknown method, or several methods: the descriptor has no name
+        return descripteurMethode{"", "", 1.0, 1.0};
+    }
+    return liste[0];
+}
+
+// Function to check that a descriptor has a known method (error on cerr otherwise)
+bool DistanceEngine::methodeValide(const descripteurMethode& m)
+{
+    if ((m.nom == "d") || (m.nom == "p") || (m.nom == "k") || (m.nom == "jc") || (m.nom == "pc") || (m.nom == "ei"))
+    {
+        return true;
+    }
+    cerr << "Error: unknown evolutionary distances method \"" << m.nom << "\".\n";
+    return false;
+}
+
+// Function to apply the gap policy to the alignment and open its pair counts cache (nullptr: no cache or avecCache false)
+unique_ptr<CachePaires> DistanceEngine::preparer(EncodedAlignment& alignement, bool avecCache, bool avecMotifs)
+{
+    avecCache = avecCache && !options.dossierCache.empty();
+
+    // Hash of the alignment before the gap policy: key of the pair counts cache
+    uint64_t empreinteAlignement = avecCache ? alignement.empreinte() : 0;
+
+    if (options.sansGaps || (options.seuilColonnes >= 0.0))
+    {
+        chronoEtape etape("gaps");
+        if (options.sansGaps)
+        {
+            journal() << "Remove gaps in the alignment.\n";
+        }
+        if (options.seuilColonnes >= 0.0)
+        {
+            journal() << "Remove the columns with more than " << options.seuilColonnes << " % of gaps and unknown amino acids.\n";
+        }
+        // Columns removed in place from the alignment (bitmap of the kept columns, rows compacted on nbThreads threads)
+        size_t supprimees = alignement.filtrerColonnes(options.sansGaps, options.seuilColonnes, options.nbThreads);
+        journal() << supprimees << " columns removed, " << alignement.taille() << " columns kept.\n";
+    }else{
+        journal() << "Default: keeping gaps.\n"; // By default gaps are keep
+    }
+    journal() << endl;
+
+    // Pair counts cache: counts of a previous run with the same alignment and gap policy are read instead of calculated
+    unique_ptr<CachePaires> cache;
+    if (avecCache)
+    {
+        cache.reset(new CachePaires(options.dossierCache, alignement.nombreSequences(), alignement.taille(), empreinteAlignement,
+            CachePaires::politiqueGaps(options.sansGaps, options.seuilColonnes)));
+    }
+
+    // The counts don't depend on the site patterns: the alignment is not compressed if the counts are read from the cache
+    if (avecMotifs && (!cache || !cache->disponible()))
+    {
+        compresser(alignement);
+    }
+    return cache;
+}
+
+// Function to compress the alignment in weighted site patterns if options.motifs is true (same counts, less columns)
+void DistanceEngine::compresser(EncodedAlignment& alignement)
+{
+    if (!options.motifs)
+    {
+        return;
+    }
+    chronoEtape etape("patterns");
+    size_t colonnes = alignement.taille();
+    size_t nbMotifs = alignement.compresserColonnes(options.nbThreads);
+    if (nbMotifs == 0)
+    {
+        journal() << "Site patterns: the alignment is not compressed.\n\n";
+        return;
+    }
+    journal() << "Site patterns: " << colonnes << " columns compressed in " << nbMotifs << " unique patterns (" << alignement.segmentsPonderes().size()
+         << " weighted segments, " << alignement.taille() << " columns compared).\n\n";
+}
+
+// Function to calculate the distances of all pairs into the matrice, identical sequences are compared once
+void DistanceEngine::remplirMatrice(EncodedAlignment& alignement, MatriceCondensee& matrice, const descripteurMethode& m,
+    CachePaires* cache)
+{
+    // The cache file has the counts of all the pairs of the alignment
+    if (cache != nullptr)
+    {
+        divergence.matriceDivergences(alignement, matrice, options.nbThreads, options.comptage, m, cache);
+        return;
+    }
+
+    // Identical sequences after the gap policy (same hash, then same residues)
+    vector<int> uniques;
+    vector<int> groupes = alignement.grouperSequences(uniques, options.nbThreads);
+    if (uniques.size() == (size_t)alignement.nombreSequences())
+    {
+        divergence.matriceDivergences(alignement, matrice, options.nbThreads, options.comptage, m);
+        return;
+    }
+    journal() << alignement.nombreSequences() - uniques.size() << " identical sequences: the " << uniques.size() << " unique sequences are compared.\n";
+
+    // Distances of the unique sequences (in memory), then expanded to the rows of all the sequences
+    MatriceCondensee distancesUniques(uniques.size());
+    divergence.matriceDivergences(alignement, distancesUniques, options.nbThreads, options.comptage, m, nullptr, &uniques);
+    divergence.developperMatrice(alignement, distancesUniques, uniques, groupes, matrice, options.nbThreads, m);
+}
+
+// Function to create an empty matrice of n sequences, in memory or in the file chemin (empty: options.fichierMatrice)
+MatriceCondensee DistanceEngine::creerMatrice(int n, const string& chemin) const
+{
+    const string& fichier = chemin.empty() ? options.fichierMatrice : chemin;
+    if (fichier.empty())
+    {
+        return MatriceCondensee(n);
+    }
+    journal() << "Distance matrice stocked in the file " << fichier << ".\n";
+    return MatriceCondensee(n, fichier);
+}
+
+// Function to calculate the distance matrice of aligned sequences in memory
+MatriceCondensee DistanceEngine::calculer(const string_view* sequences, size_t nbSequences, const descripteurMethode& m)
+{
+    if (nbSequences < 2)
+    {
+        cerr << "Error: at least 2 sequences are needed to create an evolutinary distance matrice.\n";
+        return MatriceCondensee();
+    }
+    // Views of the sequences, numbered in order (no header)
+    vector<vueFasta> vues(nbSequences);
+    for (size_t i = 0; i < nbSequences; i++)
+    {
+        if (sequences[i].size() != sequences[0].size())
+        {
+            cerr << "Error: Amino acids sequences are not aligned.\n";
+            return MatriceCondensee();
+        }
+        vues[i].n = i + 1;
+        vues[i].s = sequences[i];
+    }
+    EncodedAlignment alignement(vues);
+    if ((size_t)alignement.nombreSequences() != nbSequences)
+    {
+        return MatriceCondensee();
+    }
+    return calculer(alignement, m);
+}
+
+// Function to calculate the distance matrice of an encoded alignment with a method
+MatriceCondensee DistanceEngine::calculer(EncodedAlignment& alignement, const descripteurMethode& m)
+{
+    if (!methodeValide(m))
+    {
+        return MatriceCondensee();
+    }
+    unique_ptr<CachePaires> cache = preparer(alignement);
+    chronoEtape etape("distances");
+    MatriceCondensee matrice = creerMatrice(alignement.nombreSequences());
+    if (matrice.nombreSequences() != alignement.nombreSequences())
+    {
+        return matrice;
+    }
+    journal() << "Calculate evolutionary distances between sequences...\n";
+    // Distances estimation and evolutionary distances are calculated by blocks of rows directly into the matrice
+    remplirMatrice(alignement, matrice, m, cache.get());
+    return matrice;
+}
+
+// Function to calculate the distances estimation matrice (no correction), used by several methods with appliquer
+MatriceCondensee DistanceEngine::divergences(EncodedAlignment& alignement)
+{
+    unique_ptr<CachePaires> cache = preparer(alignement);
+    chronoEtape etape("distances");
+    MatriceCondensee matrice = creerMatrice(alignement.nombreSequences());
+    if (matrice.nombreSequences() != alignement.nombreSequences())
+    {
+        return matrice;
+    }
+    journal() << "Calculate distances estimation between sequences...\n";
+    remplirMatrice(alignement, matrice, descripteur("d"), cache.get());
+    return matrice;
+}
+
+// Function to calculate the distance matrice of a method from the distances estimation matrice
+MatriceCondensee DistanceEngine::appliquer(const MatriceCondensee& divergences, const descripteurMethode& m, const string& chemin)
+{
+    if (!methodeValide(m))
+    {
+        return MatriceCondensee();
+    }
+    chronoEtape etape("methods");
+    MatriceCondensee matrice = creerMatrice(divergences.nombreSequences(), chemin);
+    if (matrice.nombreSequences() != divergences.nombreSequences())
+    {
+        return matrice;
+    }
+    methode.appliquer(m, divergences, matrice, options.nbThreads);
+    return matrice;
+}
+
+// Function to update a previous result with the sequences added to the alignment (gaps must be kept)
+MatriceCondensee DistanceEngine::mettreAJour(EncodedAlignment& alignement, const MatricePrecedente& precedente, const descripteurMethode& m)
+{
+    // Removed columns depend on all sequences: the previous distances are valid only if all columns are kept
+    if (options.sansGaps || (options.seuilColonnes >= 0.0))
+    {
+        cerr << "Error: the incremental update can't be used with the removal of columns.\n";
+        return MatriceCondensee();
+    }
+    if (!methodeValide(m))
+    {
+        return MatriceCondensee();
+    }
+    compresser(alignement);
+    chronoEtape etape("distances");
+    MatriceCondensee matrice = creerMatrice(alignement.nombreSequences());
+    if (matrice.nombreSequences() != alignement.nombreSequences())
+    {
+        return matrice;
+    }
+    journal() << "Update the previous result with the new sequences...\n";
+    divergence.completerMatrice(alignement, precedente, matrice, options.nbThreads, options.comptage, m);
+    return matrice;
+}
+
+// Function to calculate the distances of an alignment and write them in a PHYLIP file by windows of rows (the matrice is not stocked)
+bool DistanceEngine::ecrireFlux(EncodedAlignment& alignement, const descripteurMethode& m, const string& nomFichier)
+{
+    if (!methodeValide(m))
+    {
+        return false;
+    }
+    preparer(alignement, false); // The cache is not used: each pair is calculated twice
+    chronoEtape etape("distances-stream"); // Distances and writing of the file
+    journal() << "Calculate evolutionary distances and write " << nomFichier << " by windows of rows...\n";
+    divergence.fichierMatFlux(alignement, options.nbThreads, options.comptage, m, nomFichier);
+    return true;
+}
+
+// Function to write the pairs of the alignment whose distance is at most distanceMaximum in a sparse file (the matrice is not stocked)
+bool DistanceEngine::ecrireCreux(EncodedAlignment& alignement, const descripteurMethode& m, double distanceMaximum, const string& nomFichier,
+    uint32_t precision)
+{
+    if (!methodeValide(m))
+    {
+        return false;
+    }
+    preparer(alignement, false); // The cache is not used: the counting of most pairs is stopped
+    chronoEtape etape("distances-sparse"); // Distances and writing of the file
+    FichierCreux fichier(nomFichier, alignement, m.nom, m.modele, precision, distanceMaximum);
+    if (!fichier.ouvert())
+    {
+        cerr << "The file can't be write\n";
+        return false;
+    }
+    journal() << "Calculate evolutionary distances at most " << distanceMaximum << " and write " << nomFichier << "...\n";
+    size_t interrompues = divergence.fichierCreux(alignement, options.nbThreads, options.comptage, m, distanceMaximum, fichier);
+    journal() << fichier.nombrePaires() << " pairs written, " << interrompues << " pairs stopped before the end of the alignment.\n";
+    return fichier.terminer();
+}
+
+// Function to calculate the distance matrices of bootstrap replicates of the alignment in one pass over the pairs
+vector<MatriceCondensee> DistanceEngine::bootstrap(EncodedAlignment& alignement, const descripteurMethode& m, int nbReplicats, uint64_t graine)
+{
+    if (!methodeValide(m) || (nbReplicats < 1))
+    {
+        return vector<MatriceCondensee>();
+    }
+    // The replicates draw the columns of the alignment: no site patterns, and the cache has the counts of the alignment only
+    preparer(alignement, false, false);
+    chronoEtape etape("bootstrap"); // Draw of the replicates and distances
+    journal() << "Draw " << nbReplicats << " bootstrap replicates of the " << alignement.taille() << " columns (seed " << graine << ")...\n";
+    ReplicatsBootstrap replicats(alignement, nbReplicats, graine, options.nbThreads);
+    journal() << "Bootstrap kernel: " << replicats.instructions() << ".\n";
+
+    vector<MatriceCondensee> matrices;
+    for (int r = 0; r < nbReplicats; r++)
+    {
+        matrices.push_back(creerMatrice(alignement.nombreSequences(), options.fichierMatrice.empty() ? "" : options.fichierMatrice + ".b" + to_string(r + 1)));
+        if (matrices.back().nombreSequences() != alignement.nombreSequences())
+        {
+            return vector<MatriceCondensee>();
+        }
+    }
+    journal() << "Calculate evolutionary distances of the replicates...\n";
+    divergence.matricesBootstrap(alignement, replicats, matrices, options.nbThreads, m);
+    return matrices;
+}
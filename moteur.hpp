@@ -0,0 +1,151 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class DistanceEngine: Library interface of Align, distance matrice of sequences in memory or of an encoded alignment, without files.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <stdint.h>
+
+#include "alignement.hpp" // alignement.hpp inclusion to encode the sequences
+#include "matrice.hpp" // matrice.hpp inclusion to return the condensed triangular matrice
+#include "cache.hpp" // cache.hpp inclusion to read and write the pair counts cache
+#include "incremental.hpp" // incremental.hpp inclusion to update a previous result
+#include "methode.hpp" // methode.hpp inclusion to use struct descripteurMethode and the corrections
+#include "mesures.hpp" // mesures.hpp inclusion to time the stages
+#include "bootstrap.hpp" // bootstrap.hpp inclusion to draw the bootstrap replicates
+
+#ifndef MOTEUR_HPP
+#define MOTEUR_HPP
+
+/*
+ Options du moteur de distances, communes à tous les calculs d'un objet DistanceEngine
+*/
+struct optionsMoteur
+{
+  int nbThreads = 1; // Number of threads (0: all cores)
+  std::string comptage = "byte"; // Counting engine: "byte" (SIMD comparison of bytes) or "bitsliced"
+  bool sansGaps = false; // Gap policy: true if the columns with a gap are removed before the calculation
+  double seuilColonnes = -1.0; // Columns with more than seuilColonnes % of gaps and unknown amino acids (X) are removed (negative: no threshold)
+  bool motifs = false; // True if identical columns are compressed in weighted site patterns before the counting
+  std::string fichierMatrice; // File of the distance matrice stocked on disk (empty: matrice in memory)
+  std::string dossierCache; // Directory of the pair counts cache files (empty: no cache)
+};
+
+/*
+ Interface de bibliothèque d'Align (libalign.a, libalign.so):
+   Les séquences sont données en mémoire (vues, sans fichier FASTA) ou sous forme d'alignement encodé
+   Le résultat est la matrice condensée d(1,2),...,d(1,n), d(2,3),... (MatriceCondensee), sans fichier de sortie
+   Les fonctions qui prennent un EncodedAlignment appliquent la politique des gaps (et le seuil des colonnes) sur cet alignement
+*/
+class DistanceEngine
+{
+  private:
+    optionsMoteur options; // Options of all calculations
+
+    Divergence divergence; // Distances estimation and output files
+
+    Methode methode; // Evolutionary distances methods
+
+    /*
+      Function to apply the gap policy to the alignment and open its pair counts cache (nullptr: no cache or avecCache false):
+        avecMotifs false: the alignment is not compressed in site patterns (columns drawn by the bootstrap)
+    */
+    std::unique_ptr<CachePaires> preparer(EncodedAlignment& alignement, bool avecCache = true, bool avecMotifs = true);
+
+    // Function to compress the alignment in weighted site patterns if options.motifs is true (same counts, less columns)
+    void compresser(EncodedAlignment& alignement);
+
+    /*
+      Function to calculate the distances of all pairs into the matrice with the method m ("d" for the distances estimation):
+        Identical sequences are compared once: the matrice of the unique sequences is expanded to all the sequences
+        With a cache, all the pairs are read from or written in the cache file
+    */
+    void remplirMatrice(EncodedAlignment& alignement, MatriceCondensee& matrice, const descripteurMethode& m,
+      CachePaires* cache);
+
+    // Function to create an empty matrice of n sequences, in memory or in the file chemin (empty: options.fichierMatrice)
+    MatriceCondensee creerMatrice(int n, const std::string& chemin = "") const;
+
+    // Function to check that a descriptor has a known method (error on cerr otherwise)
+    static bool methodeValide(const descripteurMethode& m);
+
+  public:
+    // DistanceEngine Class constructor
+    DistanceEngine(const optionsMoteur& optionsCalcul = optionsMoteur());
+
+    // DistanceEngine Class destructor
+    ~DistanceEngine();
+
+    // Function to get the options of the engine
+    const optionsMoteur& parametres() const { return options; };
+
+    // Function to get the descriptor of a method (ex. "p", or "pc" and "LG"): alpha and beta of the substitution model
+    // Unknown method or model: error on cerr and descriptor with an empty name, refused by the calculations
+    static descripteurMethode descripteur(const std::string& nom, const std::string& modele = "");
+
+    /*
+      Functions to calculate the distance matrice of aligned sequences in memory (nbSequences views of the same length):
+        The sequences are encoded once, the views are not used after the call
+        Sequences not aligned or less than 2 sequences: error on cerr and empty matrice (0 sequences)
+      All the calculations report their errors (unknown method, matrice file or memory) on cerr with an empty result
+    */
+    MatriceCondensee calculer(const std::string_view* sequences, size_t nbSequences, const descripteurMethode& m);
+    MatriceCondensee calculer(const std::vector<std::string_view>& sequences, const descripteurMethode& m)
+    {
+      return calculer(sequences.data(), sequences.size(), m);
+    };
+
+    // Function to calculate the distance matrice of an encoded alignment with a method
+    MatriceCondensee calculer(EncodedAlignment& alignement, const descripteurMethode& m);
+
+    // Function to calculate the distances estimation matrice (no correction), used by several methods with appliquer
+    MatriceCondensee divergences(EncodedAlignment& alignement);
+
+    // Function to calculate the distance matrice of a method from the distances estimation matrice (chemin: file of the matrice on disk)
+    MatriceCondensee appliquer(const MatriceCondensee& divergences, const descripteurMethode& m, const std::string& chemin = "");
+
+    // Function to update a previous result with the sequences added to the alignment (gaps must be kept)
+    MatriceCondensee mettreAJour(EncodedAlignment& alignement, const MatricePrecedente& precedente, const descripteurMethode& m);
+
+    // Function to calculate the distances of an alignment and write them in a PHYLIP file by windows of rows (the matrice is not stocked, false: unknown method)
+    bool ecrireFlux(EncodedAlignment& alignement, const descripteurMethode& m, const std::string& nomFichier);
+
+    /*
+      Function to write the pairs of the alignment whose distance is at most distanceMaximum in a sparse file (the matrice is not stocked):
+        precision: 4 (float32) or 8 (float64) bytes per distance of the binary format, 0: text format
+        The counting of a pair stops as soon as its substitutions are too many for the distance
+    */
+    bool ecrireCreux(EncodedAlignment& alignement, const descripteurMethode& m, double distanceMaximum, const std::string& nomFichier,
+      uint32_t precision);
+
+    /*
+      Function to calculate the distance matrices of nbReplicats bootstrap replicates of the alignment (columns drawn with the seed graine):
+        The replicates are weights of the columns: all the replicates are counted in one pass over the pairs, without resampled FASTA file
+        Matrices on disk (options.fichierMatrice): one file per replicate (ex. matrice.b1, matrice.b2...)
+        Error: no matrice
+    */
+    std::vector<MatriceCondensee> bootstrap(EncodedAlignment& alignement, const descripteurMethode& m, int nbReplicats, uint64_t graine);
+};
+#endif
@@ -0,0 +1,121 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Parallele: Execution of independent tasks (blocks of compared sequences) on several threads with work stealing.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+#include "parallele.hpp"
+
+using namespace std;
+
+// Function to stock the number of threads
+int Parallele::nombreThreads()
+{
+    return nbThreads;
+}
+
+// Function to get the next task of a thread (own queue first, then stolen from the other queues)
+bool Parallele::tacheSuivante(vector<fileTaches>& files, int numeroThread, size_t& tache)
+{
+    // The thread takes the first task of its own queue
+    {
+        lock_guard<mutex> verrou(files[numeroThread].verrou);
+        if (!files[numeroThread].taches.empty())
+        {
+            tache = files[numeroThread].taches.front();
+            files[numeroThread].taches.pop_front();
+            return true;
+        }
+    }
+    // Else the thread steals the last task of the next non empty queue
+    for (int v = 1; v < nbThreads; v++)
+    {
+        int victime = (numeroThread + v) % nbThreads;
+        lock_guard<mutex> verrou(files[victime].verrou);
+        if (!files[victime].taches.empty())
+        {
+            tache = files[victime].taches.back();
+            files[victime].taches.pop_back();
+            return true;
+        }
+    }
+    return false; // No more tasks
+}
+
+// Function to execute the tasks 0 to nbTaches-1 on all threads with work stealing
+void Parallele::executer(size_t nbTaches, const function<void(size_t)>& tache, bool alterne)
+{
+    // Only one thread: tasks are executed in order
+    if (nbThreads == 1 || nbTaches <= 1)
+    {
+        for (size_t t = 0; t < nbTaches; t++)
+        {
+            tache(t);
+        }
+        return;
+    }
+
+    // Each thread begins with a contiguous part of the tasks, or with one task out of nbThreads
+    vector<fileTaches> files(nbThreads);
+    if (alterne)
+    {
+        for (size_t k = 0; k < nbTaches; k++)
+        {
+            files[k % nbThreads].taches.push_back(k);
+        }
+    }else{
+        for (int t = 0; t < nbThreads; t++)
+        {
+            size_t debut = nbTaches * t / nbThreads;
+            size_t fin = nbTaches * (t + 1) / nbThreads;
+            for (size_t k = debut; k < fin; k++)
+            {
+                files[t].taches.push_back(k);
+            }
+        }
+    }
+
+    // Loop of one thread: execute tasks until all queues are empty
+    auto travail = [&](int numeroThread)
+    {
+        size_t numero;
+        while (tacheSuivante(files, numeroThread, numero))
+        {
+            tache(numero);
+        }
+    };
+
+    // The main thread is the thread number 0
+    vector<thread> threads;
+    for (int t = 1; t < nbThreads; t++)
+    {
+        threads.push_back(thread(travail, t));
+    }
+    travail(0);
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
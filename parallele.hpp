@@ -0,0 +1,84 @@
+/*
+    Project in C++ done for the 1st year of Master degree in Bioinformatics' intership - University of Montpellier, France (2022-2024)
+    Program Align in C++ able to calculate evolutionary distances between amino acids sequences from an aligned FASTA file and create a distance matrice using 5 methods.
+
+    Class Parallele: Execution of independent tasks (blocks of compared sequences) on several threads with work stealing.
+
+    Author: Noëlie PALERMO
+
+    Contact: palermo.n@live.fr
+
+    Version: "1.0"
+
+    Date: 09/06/2023
+
+    Licence: "This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along with this program. If not, see <https://www.gnu.org/licenses/>."
+*/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+#include "journal.hpp" // journal.hpp inclusion to write the messages of the library
+
+#ifndef PARALLELE_HPP
+#define PARALLELE_HPP
+
+/*
+ Structure pour contenir la file de tâches d'un thread.
+ Le thread prend ses tâches au début de sa file, les autres threads volent les tâches à la fin de la file
+*/
+struct fileTaches
+{
+  std::mutex verrou; // Lock of the tasks queue
+  std::deque<size_t> taches; // Tasks numbers
+};
+
+class Parallele
+{
+  private:
+    int nbThreads; // Number of threads
+
+    // Function to get the next task of a thread (own queue first, then stolen from the other queues)
+    bool tacheSuivante(std::vector<fileTaches>& files, int numeroThread, size_t& tache);
+
+  public:
+    // Parallele Class constructor (0 or a negative number of threads: all the available cores)
+    Parallele(int threads = 1)
+    {
+      nbThreads = threads;
+      if (nbThreads <= 0)
+      {
+        nbThreads = std::thread::hardware_concurrency();
+      }
+      if (nbThreads <= 0)
+      {
+        nbThreads = 1;
+      }
+      journal() << "Parallele Class constructor.\n";
+    };
+
+    // Parallele Class destructor
+    ~Parallele()
+    {
+      journal() << "Parallele Class destructor.\n";
+    };
+
+    // Function to stock the number of threads
+    int nombreThreads();
+
+    /*
+      Function to execute the tasks 0 to nbTaches-1 on all threads with work stealing:
+        alterne false: each thread begins with a contiguous part of the tasks (neighbouring rows, same cache lines)
+        alterne true: task k is given to the thread k % nbThreads (tasks sorted by decreasing cost: largest tasks first on all threads)
+    */
+    void executer(size_t nbTaches, const std::function<void(size_t)>& tache, bool alterne = false);
+};
+#endif